@@ -27,7 +27,6 @@ SOURCES += main.cpp\
     aoapplication.cpp \
     aopacket.cpp \
     packet_distribution.cpp \
-    hex_functions.cpp \
     encryption_functions.cpp \
     courtroom.cpp \
     aocharbutton.cpp \
@@ -47,7 +46,19 @@ SOURCES += main.cpp\
     aotextarea.cpp \
     aolineedit.cpp \
     aotextedit.cpp \
-    aoevidencedisplay.cpp
+    aoevidencedisplay.cpp \
+    packetframer.cpp \
+    join_cache_functions.cpp \
+    charprofilecache.cpp \
+    themeresolver.cpp \
+    configstore.cpp \
+    assetindex.cpp \
+    assetscanner.cpp \
+    callwordmatcher.cpp \
+    framecache.cpp \
+    image_functions.cpp \
+    connectionracer.cpp \
+    joincache.cpp
 
 HEADERS  += lobby.h \
     aoimage.h \
@@ -58,7 +69,6 @@ HEADERS  += lobby.h \
     aoapplication.h \
     datatypes.h \
     aopacket.h \
-    hex_functions.h \
     encryption_functions.h \
     courtroom.h \
     aocharbutton.h \
@@ -76,7 +86,19 @@ HEADERS  += lobby.h \
     aotextarea.h \
     aolineedit.h \
     aotextedit.h \
-    aoevidencedisplay.h
+    aoevidencedisplay.h \
+    packetframer.h \
+    spscqueue.h \
+    charprofilecache.h \
+    themeresolver.h \
+    configstore.h \
+    assetindex.h \
+    assetscanner.h \
+    callwordmatcher.h \
+    framecache.h \
+    image_functions.h \
+    connectionracer.h \
+    joincache.h
 
 unix:LIBS += -L$$PWD -lbass
 win32:LIBS += "$$PWD/bass.dll"
@@ -3,6 +3,13 @@
 #include "lobby.h"
 #include "courtroom.h"
 #include "networkmanager.h"
+#include "charprofilecache.h"
+#include "themeresolver.h"
+#include "configstore.h"
+#include "assetindex.h"
+#include "callwordmatcher.h"
+#include "framecache.h"
+#include "file_functions.h"
 #include "debug_functions.h"
 
 #include <QDebug>
@@ -11,14 +18,61 @@
 
 AOApplication::AOApplication(int &argc, char **argv) : QApplication(argc, argv)
 {
+  config_store = new ConfigStore(get_base_path() + "config.ini", this);
+
+  asset_index = new AssetIndex(get_base_path(), this);
+  set_asset_index(asset_index);
+  asset_index->mount_packs();
+  asset_index->build();
+
+  net_thread = new QThread(this);
+
   net_manager = new NetworkManager(this);
+  net_manager->low_delay_enabled = get_tcp_nodelay();
+  net_manager->moveToThread(net_thread);
+  //its sockets and timers belong to the network thread, so that's where it has to be deleted as well
+  QObject::connect(net_thread, SIGNAL(finished()), net_manager, SLOT(deleteLater()));
   QObject::connect(net_manager, SIGNAL(ms_connect_finished(bool)), SLOT(ms_connect_finished(bool)));
+
+  char_profiles = new CharProfileCache(this);
+
+  call_words = new CallWordMatcher(get_base_path() + "callwords.ini", this);
+
+  frame_cache = new FrameCache(get_frame_cache_size() * 1024);
+  frame_cache->set_decode_threads(get_decode_threads());
+  frame_cache->set_smooth_scaling(get_smooth_scaling());
+
+  //starts parsing the theme right away, the lobby is going to need it
+  theme_resolver = new ThemeResolver();
+  set_user_theme();
+
+  outbox_flush_timer = new QTimer(this);
+  outbox_flush_timer->setSingleShot(true);
+  outbox_flush_timer->setInterval(0);
+  QObject::connect(outbox_flush_timer, SIGNAL(timeout()), SLOT(flush_outbox()));
+
+  register_server_packet_handlers();
+
+  net_thread->start();
 }
 
 AOApplication::~AOApplication()
 {
   destruct_lobby();
   destruct_courtroom();
+
+  //net_manager is deleted on its way out
+  net_thread->quit();
+  net_thread->wait();
+  net_manager = nullptr;
+
+  delete theme_resolver;
+
+  frame_cache->dump_stats();
+  delete frame_cache;
+
+  set_asset_index(nullptr);
+  asset_index->dump_stats();
 }
 
 void AOApplication::construct_lobby()
@@ -77,6 +131,8 @@ void AOApplication::destruct_courtroom()
     return;
   }
 
+  char_profiles->cancel_prefetch();
+
   delete w_courtroom;
   courtroom_constructed = false;
 }
@@ -90,6 +146,8 @@ QString AOApplication::get_version_string(){
 
 void AOApplication::set_user_theme(){
   user_theme = read_user_theme();
+
+  theme_resolver->set_theme(get_theme_path(), get_default_theme_path());
 }
 
 void AOApplication::set_favorite_list()
@@ -121,6 +179,8 @@ void AOApplication::add_favorite_server(int p_server)
 
 void AOApplication::server_disconnected()
 {
+  dump_packet_stats();
+
   if (courtroom_constructed)
   {
     call_notice("Disconnected from server.");
@@ -7,8 +7,18 @@
 #include <QApplication>
 #include <QVector>
 #include <QFile>
+#include <QHash>
+#include <QMap>
+#include <QThread>
+#include <QTimer>
 
 class NetworkManager;
+class CharProfileCache;
+class ThemeResolver;
+class ConfigStore;
+class AssetIndex;
+class CallWordMatcher;
+class FrameCache;
 class Lobby;
 class Courtroom;
 
@@ -21,6 +31,20 @@ public:
   ~AOApplication();
 
   NetworkManager *net_manager;
+  QThread *net_thread;
+
+  //parsed char.ini files, see get_char_profile()
+  CharProfileCache *char_profiles;
+  //config.ini, read_config() and the typed getters below go through this
+  ConfigStore *config_store;
+  //everything under base/, file_exists() and dir_exists() use it
+  AssetIndex *asset_index;
+  //design and sound inis of user_theme, see set_user_theme()
+  ThemeResolver *theme_resolver;
+  //callwords.ini, checked against every IC message
+  CallWordMatcher *call_words;
+  //decoded animations, shared by every AOCharMovie and AOMovie
+  FrameCache *frame_cache;
   Lobby *w_lobby;
   Courtroom *w_courtroom;
 
@@ -33,12 +57,16 @@ public:
   void construct_courtroom();
   void destruct_courtroom();
 
+  //packets arrive here already decoded by the network thread
   void ms_packet_received(AOPacket *p_packet);
   void server_packet_received(AOPacket *p_packet);
 
   void send_ms_packet(AOPacket *p_packet);
   void send_server_packet(AOPacket *p_packet, bool encoded = true);
 
+  //prints how often each server packet type was handled and how long it took
+  void dump_packet_stats();
+
   /////////////////server metadata//////////////////
 
   unsigned int s_decryptor = 5;
@@ -59,6 +87,11 @@ public:
 
   QString server_software = "";
 
+  //the server we last connected to, set by the lobby
+  server_type current_server;
+  //digest of the server's char/evidence/music lists, if it advertises one through FL as hash=<digest>
+  QString server_list_hash = "";
+
   int char_list_size = 0;
   int loaded_chars = 0;
   int evidence_list_size = 0;
@@ -66,7 +99,15 @@ public:
   int music_list_size = 0;
   int loaded_music = 0;
 
+  //legacy loading (AN/AE/AM) keeps up to this many requests in flight. 1 is the old lock-step behaviour
+  int loading_window = 8;
+  //number of the next request in the AN#1..AN#n, AE#1..AE#n, AM#1..AM#n sequence
+  int legacy_next_request = 1;
+  int legacy_responses_received = 0;
+
   bool courtroom_loaded = false;
+  //the lists came from the join cache rather than from the server
+  bool join_cache_hit = false;
 
   //////////////////versioning///////////////
 
@@ -100,24 +141,53 @@ public:
   QString get_default_background_path();
   QString get_evidence_path();
 
+  //implementation in join_cache_functions.cpp
+  bool load_join_cache();
+  void save_join_cache();
+
   //implementation in text_file_functions.cpp
   QString read_config(QString searchline);
   QString read_user_theme();
   int read_blip_rate();
+  int get_loading_window();
   bool get_blank_blip();
+  //true if timed_preanims in config.ini is true. preanims are then cut off once their [Time] entry runs out
+  bool get_timed_preanims();
+  bool get_tcp_nodelay();
+
+  //returns the value of prefetch_threads in config.ini, 2 if it isn't there
+  int get_prefetch_threads();
+
+  //returns the value of char_profile_cache in config.ini, 256 if it isn't there
+  //that many char.ini files are kept parsed, and at most that many are prefetched
+  int get_char_profile_cache_size();
+
+  //returns the value of frame_cache_mb in config.ini, 128 if it isn't there
+  int get_frame_cache_size();
+
+  //returns the value of decode_threads in config.ini, 2 if it isn't there
+  int get_decode_threads();
+
+  //true if image_quality in config.ini is smooth. anything else means fast, which is how images were always scaled
+  bool get_smooth_scaling();
   int get_default_music();
   int get_default_sfx();
   int get_default_blip();
   QStringList get_call_words();
   void write_to_serverlist_txt(QString p_line);
   QVector<server_type> read_serverlist_txt();
-  QString read_design_ini(QString p_identifier, QString p_design_path);
   QPoint get_button_spacing(QString p_identifier, QString p_file);
   pos_size_type get_element_dimensions(QString p_identifier, QString p_file);
   int get_font_size(QString p_identifier, QString p_file);
   QColor get_color(QString p_identifier, QString p_file);
   QString get_sfx(QString p_identifier);
-  QString read_char_ini(QString p_char, QString p_search_line, QString target_tag, QString terminator_tag);
+  char_profile_type get_char_profile(QString p_char);
+
+  //loads the profiles of everyone in p_chars in the background, recent speakers first
+  void prefetch_char_profiles(const QVector<char_type> &p_chars);
+  //remembers p_char as having spoken just now
+  void note_speaker(QString p_char);
+  QString read_char_ini(QString p_char, QString p_search_line, QString target_tag);
   QString get_char_side(QString p_char);
   QString get_showname(QString p_char);
   QString get_chat(QString p_char);
@@ -127,6 +197,8 @@ public:
   int get_text_delay(QString p_char, QString p_emote);
   QString get_char_name(QString p_char);
   int get_emote_number(QString p_char);
+  QVector<emote_type> get_emote_list(QString p_char);
+  emote_type get_emote_info(QString p_char, int p_emote);
   QString get_emote_comment(QString p_char, int p_emote);
   QString get_emote(QString p_char, int p_emote);
   QString get_pre_emote(QString p_char, int p_emote);
@@ -146,8 +218,77 @@ private:
   QVector<server_type> server_list;
   QVector<server_type> favorite_list;
 
+  //fires once the current event loop turn is done, so everything sent during the turn goes out in one write
+  QTimer *outbox_flush_timer;
+
+  //more than this per drain and the rest waits for the next event loop iteration, so a burst can't starve painting
+  const int max_packets_per_drain = 64;
+
+  typedef void (AOApplication::*server_packet_handler)(AOPacket *p_packet);
+
+  struct packet_handler_type
+  {
+    packet_handler_type(server_packet_handler p_handler = nullptr) : handler(p_handler) {}
+
+    server_packet_handler handler;
+    int count = 0;
+    qint64 total_nsecs = 0;
+    qint64 max_nsecs = 0;
+  };
+
+  //header -> handler, filled once in the constructor
+  QHash<QString, packet_handler_type> server_packet_handlers;
+
+  //characters seen in MS packets, most recent first. kept across servers
+  QStringList recent_speakers;
+  const int max_recent_speakers = 32;
+
+  //legacy pages that arrived ahead of the ones before them, keyed by their first index
+  QMap<int, QStringList> pending_char_pages;
+  QMap<int, QStringList> pending_evidence;
+  QMap<int, QStringList> pending_music_pages;
+
+  //implementation in packet_distribution.cpp
+  void append_char_page(const QStringList &p_fields);
+  void append_evidence(const QStringList &p_fields);
+  void append_music_page(const QStringList &p_fields);
+  void send_legacy_loading_requests();
+
+  void register_server_packet_handlers();
+  void handle_decryptor_packet(AOPacket *p_packet);
+  void handle_id_packet(AOPacket *p_packet);
+  void handle_ct_packet(AOPacket *p_packet);
+  void handle_fl_packet(AOPacket *p_packet);
+  void handle_pn_packet(AOPacket *p_packet);
+  void handle_si_packet(AOPacket *p_packet);
+  void handle_ci_packet(AOPacket *p_packet);
+  void handle_ei_packet(AOPacket *p_packet);
+  void handle_em_packet(AOPacket *p_packet);
+  void handle_charscheck_packet(AOPacket *p_packet);
+  void handle_sc_packet(AOPacket *p_packet);
+  void handle_sm_packet(AOPacket *p_packet);
+  void handle_done_packet(AOPacket *p_packet);
+  void handle_bn_packet(AOPacket *p_packet);
+  void handle_pv_packet(AOPacket *p_packet);
+  void handle_ms_packet(AOPacket *p_packet);
+  void handle_confirm_packet(AOPacket *p_packet);
+  void handle_mc_packet(AOPacket *p_packet);
+  void handle_rt_packet(AOPacket *p_packet);
+  void handle_hp_packet(AOPacket *p_packet);
+  void handle_le_packet(AOPacket *p_packet);
+  void handle_il_packet(AOPacket *p_packet);
+  void handle_mu_packet(AOPacket *p_packet);
+  void handle_um_packet(AOPacket *p_packet);
+  void handle_kk_packet(AOPacket *p_packet);
+  void handle_kb_packet(AOPacket *p_packet);
+  void handle_bd_packet(AOPacket *p_packet);
+  void handle_zz_packet(AOPacket *p_packet);
+
 private slots:
   void ms_connect_finished(bool connected);
+  //picks up whatever the network thread has received, see NetworkManager::post_inbound_packet
+  void drain_inbox();
+  void flush_outbox();
 
 public slots:
   void server_disconnected();
@@ -1,5 +1,7 @@
 #include "aoblipplayer.h"
 
+#include "file_functions.h"
+
 #include <string.h>
 
 #include <QDebug>
@@ -10,15 +12,37 @@ AOBlipPlayer::AOBlipPlayer(QWidget *parent, AOApplication *p_ao_app)
   ao_app = p_ao_app;
 }
 
+AOBlipPlayer::~AOBlipPlayer()
+{
+  //the streams aren't freed on their own and may still be reading from m_data
+  for (int n_stream = 0 ; n_stream < 5 ; ++n_stream)
+  {
+    BASS_ChannelStop(m_stream_list[n_stream]);
+    BASS_StreamFree(m_stream_list[n_stream]);
+  }
+}
+
 void AOBlipPlayer::set_blips(QString p_sfx)
 {
-  QString f_path = ao_app->get_sounds_path() + p_sfx.toLower();
+  QString f_path = resolve_path(ao_app->get_sounds_path() + p_sfx);
 
+  //every stream has to be gone before the data they play from is replaced
   for (int n_stream = 0 ; n_stream < 5 ; ++n_stream)
-  {
     BASS_StreamFree(m_stream_list[n_stream]);
 
-    m_stream_list[n_stream] = BASS_StreamCreateFile(FALSE, f_path.utf16(), 0, 0, BASS_UNICODE | BASS_ASYNCFILE);
+  bool f_packed = is_packed_path(f_path);
+
+  if (f_packed)
+    m_data = get_packed_file(f_path);
+  else
+    m_data.clear();
+
+  for (int n_stream = 0 ; n_stream < 5 ; ++n_stream)
+  {
+    if (f_packed)
+      m_stream_list[n_stream] = BASS_StreamCreateFile(TRUE, m_data.constData(), 0, m_data.size(), 0);
+    else
+      m_stream_list[n_stream] = BASS_StreamCreateFile(FALSE, f_path.utf16(), 0, 0, BASS_UNICODE | BASS_ASYNCFILE);
   }
 
   set_volume(m_volume);
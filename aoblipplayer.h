@@ -5,11 +5,13 @@
 #include "aoapplication.h"
 
 #include <QWidget>
+#include <QByteArray>
 
 class AOBlipPlayer
 {
 public:
   AOBlipPlayer(QWidget *parent, AOApplication *p_ao_app);
+  ~AOBlipPlayer();
 
   void set_blips(QString p_sfx);
   void blip_tick();
@@ -22,7 +24,9 @@ private:
   AOApplication *ao_app;
 
   int m_volume;
-  HSTREAM m_stream_list[5];
+  HSTREAM m_stream_list[5] = {};
+  //what the streams play from if the blips are packed, all five share it
+  QByteArray m_data;
 };
 
 #endif // AOBLIPPLAYER_H
@@ -25,6 +25,11 @@ AOCharButton::AOCharButton(QWidget *parent, AOApplication *p_ao_app, int x_pos,
   ui_passworded->setAttribute(Qt::WA_TransparentForMouseEvents);
   ui_passworded->hide();
 
+  missing_effect = new QGraphicsOpacityEffect(this);
+  missing_effect->setOpacity(0.4);
+  missing_effect->setEnabled(false);
+  this->setGraphicsEffect(missing_effect);
+
   ui_selector = new AOImage(parent, ao_app);
   ui_selector->resize(62, 62);
   ui_selector->move(x_pos - 1, y_pos - 1);
@@ -38,6 +43,7 @@ void AOCharButton::reset()
   ui_taken->hide();
   ui_passworded->hide();
   ui_selector->hide();
+  missing_effect->setEnabled(false);
 }
 
 void AOCharButton::set_taken()
@@ -53,8 +59,8 @@ void AOCharButton::set_passworded()
 void AOCharButton::set_image(QString p_character)
 {
   QString image_path = ao_app->get_character_path(p_character) + "char_icon.png";
-  QString legacy_path = ao_app->get_demothings_path() + p_character.toLower() + "_char_icon.png";
-  QString alt_path = ao_app->get_demothings_path() + p_character.toLower() + "_off.png";
+  QString legacy_path = resolve_path(ao_app->get_demothings_path() + p_character + "_char_icon.png");
+  QString alt_path = resolve_path(ao_app->get_demothings_path() + p_character + "_off.png");
 
   this->setText("");
 
@@ -73,6 +79,17 @@ void AOCharButton::set_image(QString p_character)
   }
 }
 
+void AOCharButton::set_name(QString p_character)
+{
+  this->setStyleSheet("border-image:url()");
+  this->setText(p_character);
+}
+
+void AOCharButton::set_missing()
+{
+  missing_effect->setEnabled(true);
+}
+
 void AOCharButton::enterEvent(QEvent * e)
 {
   ui_selector->raise();
@@ -6,6 +6,7 @@
 #include <QPushButton>
 #include <QString>
 #include <QWidget>
+#include <QGraphicsOpacityEffect>
 #include "aoimage.h"
 
 class AOCharButton : public QPushButton
@@ -22,6 +23,10 @@ public:
   void set_passworded();
 
   void set_image(QString p_character);
+  //for characters that are known to have no icon, shows the name without looking for one
+  void set_name(QString p_character);
+  //greys the button out
+  void set_missing();
 
 private:
   QWidget *m_parent;
@@ -30,6 +35,8 @@ private:
   AOImage *ui_passworded;
   AOImage *ui_selector;
 
+  QGraphicsOpacityEffect *missing_effect;
+
 protected:
   void enterEvent(QEvent *e);
   void leaveEvent(QEvent *e);
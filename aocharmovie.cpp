@@ -3,83 +3,90 @@
 #include "misc_functions.h"
 #include "file_functions.h"
 #include "aoapplication.h"
-
-#include <QDebug>
-#include <QImageReader>
+#include "framecache.h"
 
 AOCharMovie::AOCharMovie(QWidget *p_parent, AOApplication *p_ao_app) : QLabel(p_parent)
 {
   ao_app = p_ao_app;
 
-  m_movie = new QMovie(this);
+  frame_timer = new QTimer(this);
+  frame_timer->setSingleShot(true);
 
   preanim_timer = new QTimer(this);
   preanim_timer->setSingleShot(true);
 
-  connect(m_movie, SIGNAL(frameChanged(int)), this, SLOT(frame_change(int)));
+  connect(frame_timer, SIGNAL(timeout()), this, SLOT(frame_change()));
   connect(preanim_timer, SIGNAL(timeout()), this, SLOT(timer_done()));
+  connect(ao_app->frame_cache, SIGNAL(frames_ready(QString)), this, SLOT(on_frames_ready(QString)));
 }
 
 void AOCharMovie::play(QString p_char, QString p_emote, QString emote_prefix)
 {
-  QString original_path = ao_app->get_character_path(p_char) + emote_prefix + p_emote.toLower() + ".gif";
-  QString alt_path = ao_app->get_character_path(p_char) + p_emote.toLower() + ".png";
+  load(p_char, p_emote, emote_prefix);
+  start();
+}
+
+void AOCharMovie::load(QString p_char, QString p_emote, QString emote_prefix)
+{
+  m_path = find_path(p_char, p_emote, emote_prefix);
+
+  frame_timer->stop();
+
+  fetch_frames();
+}
+
+void AOCharMovie::fetch_frames()
+{
+  m_key = FrameCache::make_key(m_path, this->size(), m_flipped);
+  m_frame_set = ao_app->frame_cache->get_frames(m_path, this->size(), m_flipped);
+
+  //the rest is on its way, until then the first frame has to do
+  if (m_frame_set.isNull())
+    m_frame_set = ao_app->frame_cache->get_first_frame(m_path, this->size(), m_flipped);
+}
+
+void AOCharMovie::prefetch(QString p_char, QString p_emote, QString emote_prefix, bool p_flipped)
+{
+  ao_app->frame_cache->prefetch(find_path(p_char, p_emote, emote_prefix), this->size(), p_flipped);
+}
+
+QString AOCharMovie::find_path(QString p_char, QString p_emote, QString emote_prefix)
+{
+  QString char_path = ao_app->get_character_path(p_char);
+  QString original_path = resolve_path(char_path + emote_prefix + p_emote + ".gif");
+  QString alt_path = resolve_path(char_path + p_emote + ".png");
   QString placeholder_path = ao_app->get_theme_path() + "placeholder.gif";
   QString placeholder_default_path = ao_app->get_default_theme_path() + "placeholder.gif";
-  QString gif_path;
 
   if (file_exists(original_path))
-    gif_path = original_path;
+    return original_path;
   else if (file_exists(alt_path))
-    gif_path = alt_path;
+    return alt_path;
   else if (file_exists(placeholder_path))
-    gif_path = placeholder_path;
+    return placeholder_path;
   else
-    gif_path = placeholder_default_path;
-
-  m_movie->stop();
-  m_movie->setFileName(gif_path);
-
-  QImageReader *reader = new QImageReader(gif_path);
-
-  movie_frames.clear();
-  QImage f_image = reader->read();
-  while (!f_image.isNull())
-  {
-    if (m_flipped)
-      movie_frames.append(f_image.mirrored(true, false));
-    else
-      movie_frames.append(f_image);
-    f_image = reader->read();
-  }
+    return placeholder_default_path;
+}
 
-  delete reader;
+void AOCharMovie::start()
+{
+  m_frame = 0;
 
   this->show();
-  m_movie->start();
+  show_frame();
 }
 
 void AOCharMovie::play_pre(QString p_char, QString p_emote, int duration)
 {
-  QString gif_path = ao_app->get_character_path(p_char) + p_emote.toLower();
-
-  m_movie->stop();
-  this->clear();
-  m_movie->setFileName(gif_path);
-  m_movie->jumpToFrame(0);
-
   int full_duration = duration * time_mod;
   int real_duration = 0;
 
-  play_once = false;
+  //the length of the file never used to make it in here, so every preanim played to its end whatever its
+  //[Time] said. cutting preanims short has to be asked for. no frame has to be decoded for the length
+  if (ao_app->get_timed_preanims())
+    real_duration = ao_app->frame_cache->get_info(find_path(p_char, p_emote, "")).total_duration;
 
-  for (int n_frame = 0 ; n_frame < m_movie->frameCount() ; ++n_frame)
-  {
-    real_duration += m_movie->nextFrameDelay();
-    m_movie->jumpToFrame(n_frame + 1);
-  }
-  qDebug() << "full_duration: " << full_duration;
-  qDebug() << "real_duration: " << real_duration;
+  play_once = false;
 
   double percentage_modifier = 100.0;
 
@@ -91,7 +98,6 @@ void AOCharMovie::play_pre(QString p_char, QString p_emote, int duration)
     if (percentage_modifier > 100.0)
       percentage_modifier = 100.0;
   }
-  qDebug() << "% mod: " << percentage_modifier;
 
   if (full_duration == 0 || full_duration >= real_duration)
   {
@@ -103,66 +109,93 @@ void AOCharMovie::play_pre(QString p_char, QString p_emote, int duration)
     preanim_timer->start(full_duration);
   }
 
-
-  m_movie->setSpeed(static_cast<int>(percentage_modifier));
+  m_speed = static_cast<int>(percentage_modifier);
   play(p_char, p_emote, "");
 }
 
 void AOCharMovie::play_talking(QString p_char, QString p_emote)
 {
-    QString gif_path = ao_app->get_character_path(p_char) + "(b)" + p_emote.toLower();
-
-    m_movie->stop();
-    this->clear();
-    m_movie->setFileName(gif_path);
-
-    play_once = false;
-    m_movie->setSpeed(100);
-    play(p_char, p_emote, "(b)");
+  play_once = false;
+  m_speed = 100;
+  play(p_char, p_emote, "(b)");
 }
 
 void AOCharMovie::play_idle(QString p_char, QString p_emote)
 {
-  QString gif_path = ao_app->get_character_path(p_char) + "(a)" + p_emote.toLower();
-
-  m_movie->stop();
-  this->clear();
-  m_movie->setFileName(gif_path);
-
   play_once = false;
-  m_movie->setSpeed(100);
+  m_speed = 100;
   play(p_char, p_emote, "(a)");
 }
 
 void AOCharMovie::stop()
 {
   //for all intents and purposes, stopping is the same as hiding. at no point do we want a frozen gif to display
-  m_movie->stop();
+  frame_timer->stop();
   preanim_timer->stop();
   this->hide();
+
+  //lets the cache drop the frames if it needs the room
+  m_frame_set.clear();
 }
 
 void AOCharMovie::combo_resize(int w, int h)
 {
   QSize f_size(w, h);
+
+  //the frames are made for one size, so they only have to be made again if that changed
+  if (f_size == this->size())
+    return;
+
   this->resize(f_size);
-  m_movie->setScaledSize(f_size);
+
+  //whatever is playing carries on from the same frame at the new size
+  if (!m_frame_set.isNull())
+    fetch_frames();
 }
 
-void AOCharMovie::frame_change(int n_frame)
+void AOCharMovie::show_frame()
 {
-  if (movie_frames.size() > n_frame)
+  int f_frame_count = m_frame_set->frames.size();
+
+  //a stand-in doesn't move and doesn't end anything, on_frames_ready() starts over once the real frames are in
+  if (!m_frame_set->complete)
   {
-    QPixmap f_pixmap = QPixmap::fromImage(movie_frames.at(n_frame));
+    if (f_frame_count > 0)
+      this->setPixmap(m_frame_set->frames.at(0));
 
-    this->setPixmap(f_pixmap.scaled(this->width(), this->height()));
+    return;
   }
 
-  if (m_movie->frameCount() - 1 == n_frame && play_once)
+  if (f_frame_count == 0)
   {
-    preanim_timer->start(m_movie->nextFrameDelay());
-    m_movie->stop();
+    //nothing could be read, a preanim still has to end
+    if (play_once)
+      preanim_timer->start(0);
+
+    return;
   }
+
+  if (m_frame >= f_frame_count)
+    m_frame = 0;
+
+  this->setPixmap(m_frame_set->frames.at(m_frame));
+
+  int f_delay = m_frame_set->delays.at(m_frame) * 100 / qMax(1, m_speed);
+
+  if (m_frame == f_frame_count - 1 && play_once)
+  {
+    preanim_timer->start(f_delay);
+    return;
+  }
+
+  if (f_frame_count > 1)
+    frame_timer->start(f_delay);
+}
+
+void AOCharMovie::frame_change()
+{
+  ++m_frame;
+  show_frame();
 }
 
 void AOCharMovie::timer_done()
@@ -170,3 +203,20 @@ void AOCharMovie::timer_done()
 
   done();
 }
+
+void AOCharMovie::on_frames_ready(QString p_key)
+{
+  if (m_frame_set.isNull() || m_frame_set->complete || p_key != m_key)
+    return;
+
+  QSharedPointer<const frame_set_type> f_frame_set = ao_app->frame_cache->get_frames(m_path, this->size(), m_flipped);
+
+  if (f_frame_set.isNull())
+    return;
+
+  m_frame_set = f_frame_set;
+
+  frame_timer->stop();
+  m_frame = 0;
+  show_frame();
+}
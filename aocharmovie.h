@@ -1,9 +1,11 @@
 #ifndef AOCHARMOVIE_H
 #define AOCHARMOVIE_H
 
-#include <QMovie>
 #include <QLabel>
 #include <QTimer>
+#include <QSharedPointer>
+
+struct frame_set_type;
 
 class AOApplication;
 
@@ -19,6 +21,9 @@ public:
   void play_talking(QString p_char, QString p_emote);
   void play_idle(QString p_char, QString p_emote);
 
+  //starts decoding what play() would show for these in the background, at the size this is now
+  void prefetch(QString p_char, QString p_emote, QString emote_prefix, bool p_flipped);
+
   void set_flipped(bool p_flipped) {m_flipped = p_flipped;}
 
   void stop();
@@ -28,8 +33,17 @@ public:
 private:
   AOApplication *ao_app;
 
-  QMovie *m_movie;
-  QVector<QImage> movie_frames;
+  //file and frames of whatever is playing, shared with the frame cache
+  QString m_path;
+  //the frame cache key m_frame_set is going to be complete under
+  QString m_key;
+  QSharedPointer<const frame_set_type> m_frame_set;
+  int m_frame = 0;
+  //in percent, scales the delays of the frames the same way QMovie::setSpeed did
+  int m_speed = 100;
+
+  //fires when the current frame has been up long enough
+  QTimer *frame_timer;
   QTimer *preanim_timer;
 
   const int time_mod = 62;
@@ -38,12 +52,19 @@ private:
 
   bool play_once = true;
 
+  QString find_path(QString p_char, QString p_emote, QString emote_prefix);
+  void load(QString p_char, QString p_emote, QString emote_prefix);
+  void fetch_frames();
+  void start();
+  void show_frame();
+
 signals:
   void done();
 
 private slots:
-  void frame_change(int n_frame);
+  void frame_change();
   void timer_done();
+  void on_frames_ready(QString p_key);
 };
 
 #endif // AOCHARMOVIE_H
@@ -14,11 +14,11 @@ AOEmoteButton::AOEmoteButton(QWidget *p_parent, AOApplication *p_ao_app, int p_x
   connect(this, SIGNAL(clicked()), this, SLOT(on_clicked()));
 }
 
-void AOEmoteButton::set_image(QString p_char, int p_emote, QString suffix)
+void AOEmoteButton::set_image(QString p_char, int p_emote, QString p_comment, QString suffix)
 {
   QString emotion_number = QString::number(p_emote + 1);
-  QString image_path = ao_app->get_character_path(p_char) + "emotions/ao2/button" + emotion_number + suffix;
-  QString alt_path = ao_app->get_character_path(p_char) + "emotions/button" + emotion_number + suffix;
+  QString image_path = resolve_path(ao_app->get_character_path(p_char) + "emotions/ao2/button" + emotion_number + suffix);
+  QString alt_path = resolve_path(ao_app->get_character_path(p_char) + "emotions/button" + emotion_number + suffix);
 
   if (file_exists(image_path))
   {
@@ -32,7 +32,7 @@ void AOEmoteButton::set_image(QString p_char, int p_emote, QString suffix)
   }
   else
   {
-    this->setText(ao_app->get_emote_comment(p_char, p_emote));
+    this->setText(p_comment);
     this->setStyleSheet("border-image:url(\"\")");
   }
 }
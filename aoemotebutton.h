@@ -14,7 +14,8 @@ public:
 
   //void set_on(QString p_char, int p_emote);
   //void set_off(QString p_char, int p_emote);
-  void set_image(QString p_char, int p_emote, QString suffix);
+  //p_comment is shown instead if the character has no button image for the emote
+  void set_image(QString p_char, int p_emote, QString p_comment, QString suffix);
 
   void set_id(int p_id) {m_id = p_id;}
   int get_id() {return m_id;}
@@ -4,17 +4,21 @@
 
 #include "file_functions.h"
 #include "datatypes.h"
-#include "misc_functions.h"
+#include "framecache.h"
+#include "image_functions.h"
 
 AOEvidenceDisplay::AOEvidenceDisplay(QWidget *p_parent, AOApplication *p_ao_app) : QLabel(p_parent)
 {
   ao_app = p_ao_app;
 
-  evidence_movie = new QMovie(this);
   evidence_icon = new QLabel(this);
   sfx_player = new AOSfxPlayer(this, ao_app);
 
-  connect(evidence_movie, SIGNAL(frameChanged(int)), this, SLOT(frame_change(int)));
+  frame_timer = new QTimer(this);
+  frame_timer->setSingleShot(true);
+
+  connect(frame_timer, SIGNAL(timeout()), this, SLOT(frame_change()));
+  connect(ao_app->frame_cache, SIGNAL(frames_ready(QString)), this, SLOT(on_frames_ready(QString)));
 }
 
 void AOEvidenceDisplay::show_evidence(QString p_evidence_image, bool is_left_side, int p_volume)
@@ -25,8 +29,6 @@ void AOEvidenceDisplay::show_evidence(QString p_evidence_image, bool is_left_sid
 
   QString f_evidence_path = ao_app->get_evidence_path() + p_evidence_image;
 
-  QPixmap f_pixmap(f_evidence_path);
-
   QString final_gif_path;
   QString gif_name;
   QString icon_identifier;
@@ -47,7 +49,8 @@ void AOEvidenceDisplay::show_evidence(QString p_evidence_image, bool is_left_sid
   evidence_icon->move(icon_dimensions.x, icon_dimensions.y);
   evidence_icon->resize(icon_dimensions.width, icon_dimensions.height);
 
-  evidence_icon->setPixmap(f_pixmap.scaled(evidence_icon->width(), evidence_icon->height(), Qt::IgnoreAspectRatio));
+  QImage f_icon = read_scaled_image(f_evidence_path, evidence_icon->size(), ao_app->get_smooth_scaling());
+  evidence_icon->setPixmap(QPixmap::fromImage(f_icon));
 
   QString f_default_gif_path = ao_app->get_default_theme_path() + gif_name;
   QString f_gif_path = ao_app->get_theme_path() + gif_name;
@@ -57,35 +60,75 @@ void AOEvidenceDisplay::show_evidence(QString p_evidence_image, bool is_left_sid
   else
     final_gif_path = f_default_gif_path;
 
-  evidence_movie->setFileName(final_gif_path);
+  //shown at the size it comes in, like QMovie did
+  m_path = final_gif_path;
+  m_key = FrameCache::make_key(m_path, QSize(), false);
+  m_frame_set = ao_app->frame_cache->get_frames(m_path, QSize(), false);
+
+  //the rest is on its way, until then the first frame has to do
+  if (m_frame_set.isNull())
+    m_frame_set = ao_app->frame_cache->get_first_frame(m_path, QSize(), false);
 
-  if(evidence_movie->frameCount() < 1)
+  if (m_frame_set->frames.isEmpty())
+  {
+    m_frame_set.clear();
     return;
+  }
 
-  this->setMovie(evidence_movie);
+  m_frame = 0;
+  show_frame();
 
-  evidence_movie->start();
   sfx_player->play(ao_app->get_sfx("evidence_present"));
 }
 
-void AOEvidenceDisplay::frame_change(int p_frame)
+void AOEvidenceDisplay::show_frame()
 {
-  if (p_frame == (evidence_movie->frameCount() - 1))
+  //nothing more to show, the icon takes over
+  if (m_frame >= m_frame_set->frames.size())
   {
-    //we need this or else the last frame wont show
-    delay(evidence_movie->nextFrameDelay());
-
-    evidence_movie->stop();
+    m_frame_set.clear();
     this->clear();
 
     evidence_icon->show();
+    return;
   }
+
+  this->setPixmap(m_frame_set->frames.at(m_frame));
+
+  //a stand-in stays put, on_frames_ready() starts over once the real frames are in
+  if (!m_frame_set->complete)
+    return;
+
+  //the last frame stays up for its own delay too
+  frame_timer->start(m_frame_set->delays.at(m_frame));
+}
+
+void AOEvidenceDisplay::frame_change()
+{
+  ++m_frame;
+  show_frame();
+}
+
+void AOEvidenceDisplay::on_frames_ready(QString p_key)
+{
+  if (m_frame_set.isNull() || m_frame_set->complete || p_key != m_key)
+    return;
+
+  QSharedPointer<const frame_set_type> f_frame_set = ao_app->frame_cache->get_frames(m_path, QSize(), false);
+
+  if (f_frame_set.isNull())
+    return;
+
+  m_frame_set = f_frame_set;
+  m_frame = 0;
+  show_frame();
 }
 
 void AOEvidenceDisplay::reset()
 {
   sfx_player->stop();
-  evidence_movie->stop();
+  frame_timer->stop();
+  m_frame_set.clear();
   evidence_icon->hide();
   this->clear();
 }
@@ -2,11 +2,14 @@
 #define AOEVIDENCEDISPLAY_H
 
 #include <QLabel>
-#include <QMovie>
+#include <QTimer>
+#include <QSharedPointer>
 
 #include "aoapplication.h"
 #include "aosfxplayer.h"
 
+struct frame_set_type;
+
 class AOEvidenceDisplay : public QLabel
 {
   Q_OBJECT
@@ -20,12 +23,22 @@ public:
 
 private:
   AOApplication *ao_app;
-  QMovie *evidence_movie;
   QLabel *evidence_icon;
   AOSfxPlayer *sfx_player;
 
+  //the appear animation, shared with the frame cache
+  QString m_path;
+  QString m_key;
+  QSharedPointer<const frame_set_type> m_frame_set;
+  int m_frame = 0;
+
+  QTimer *frame_timer;
+
+  void show_frame();
+
 private slots:
-  void frame_change(int p_frame);
+  void frame_change();
+  void on_frames_ready(QString p_key);
 };
 
 #endif // AOEVIDENCEDISPLAY_H
@@ -1,4 +1,5 @@
 #include "file_functions.h"
+#include "image_functions.h"
 
 #include "aoimage.h"
 
@@ -27,9 +28,9 @@ void AOImage::set_image(QString p_image)
   else
     final_image_path = default_image_path;
 
-  QPixmap f_pixmap(final_image_path);
+  QImage f_image = read_scaled_image(final_image_path, this->size(), ao_app->get_smooth_scaling());
 
-  this->setPixmap(f_pixmap.scaled(this->width(), this->height(), Qt::IgnoreAspectRatio));
+  this->setPixmap(QPixmap::fromImage(f_image));
 }
 
 void AOImage::set_image_from_path(QString p_path)
@@ -43,7 +44,7 @@ void AOImage::set_image_from_path(QString p_path)
   else
     final_path = default_path;
 
-  QPixmap f_pixmap(final_path);
+  QImage f_image = read_scaled_image(final_path, this->size(), ao_app->get_smooth_scaling());
 
-  this->setPixmap(f_pixmap.scaled(this->width(), this->height(), Qt::IgnoreAspectRatio));
+  this->setPixmap(QPixmap::fromImage(f_image));
 }
@@ -2,17 +2,21 @@
 
 #include "file_functions.h"
 #include "courtroom.h"
-#include "misc_functions.h"
+#include "framecache.h"
 
 AOMovie::AOMovie(QWidget *p_parent, AOApplication *p_ao_app) : QLabel(p_parent)
 {
   ao_app = p_ao_app;
 
-  m_movie = new QMovie();
+  frame_timer = new QTimer(this);
+  frame_timer->setSingleShot(true);
 
-  this->setMovie(m_movie);
+  done_timer = new QTimer(this);
+  done_timer->setSingleShot(true);
 
-  connect(m_movie, SIGNAL(frameChanged(int)), this, SLOT(frame_change(int)));
+  connect(frame_timer, SIGNAL(timeout()), this, SLOT(frame_change()));
+  connect(done_timer, SIGNAL(timeout()), this, SLOT(done_timer_done()));
+  connect(ao_app->frame_cache, SIGNAL(frames_ready(QString)), this, SLOT(on_frames_ready(QString)));
 }
 
 void AOMovie::set_play_once(bool p_play_once)
@@ -22,15 +26,13 @@ void AOMovie::set_play_once(bool p_play_once)
 
 void AOMovie::play(QString p_gif, QString p_char, QString p_custom_theme)
 {
-  m_movie->stop();
-
   QString gif_path;
 
   QString custom_path;
   if (p_gif == "custom")
-    custom_path = ao_app->get_character_path(p_char) + p_gif + ".gif";
+    custom_path = resolve_path(ao_app->get_character_path(p_char) + p_gif + ".gif");
   else
-    custom_path = ao_app->get_character_path(p_char) + p_gif + "_bubble.gif";
+    custom_path = resolve_path(ao_app->get_character_path(p_char) + p_gif + "_bubble.gif");
 
   QString custom_theme_path = ao_app->get_base_path() + "themes/" + p_custom_theme + "/" + p_gif + ".gif";
   QString theme_path = ao_app->get_theme_path() + p_gif + ".gif";
@@ -53,35 +55,109 @@ void AOMovie::play(QString p_gif, QString p_char, QString p_custom_theme)
   else
     gif_path = "";
 
-  m_movie->setFileName(gif_path);
+  frame_timer->stop();
+  done_timer->stop();
+
+  m_path = gif_path;
+  fetch_frames();
+  m_frame = 0;
 
   this->show();
-  m_movie->start();
+  show_frame();
 }
 
 void AOMovie::stop()
 {
-  m_movie->stop();
+  frame_timer->stop();
+  done_timer->stop();
   this->hide();
+
+  m_frame_set.clear();
+}
+
+void AOMovie::fetch_frames()
+{
+  m_key = FrameCache::make_key(m_path, this->size(), false);
+  m_frame_set = ao_app->frame_cache->get_frames(m_path, this->size(), false);
+
+  //the rest is on its way, until then the first frame has to do
+  if (m_frame_set.isNull())
+    m_frame_set = ao_app->frame_cache->get_first_frame(m_path, this->size(), false);
 }
 
-void AOMovie::frame_change(int n_frame)
+void AOMovie::show_frame()
 {
-  if (n_frame == (m_movie->frameCount() - 1) && play_once)
+  int f_frame_count = m_frame_set->frames.size();
+
+  if (f_frame_count == 0)
+    return;
+
+  //a stand-in stays put, on_frames_ready() starts over once the real frames are in
+  if (!m_frame_set->complete)
   {
-    //we need this or else the last frame wont show
-    delay(m_movie->nextFrameDelay());
+    this->setPixmap(m_frame_set->frames.at(0));
+    return;
+  }
+
+  if (m_frame >= f_frame_count)
+    m_frame = 0;
+
+  this->setPixmap(m_frame_set->frames.at(m_frame));
 
-    this->stop();
+  int f_delay = m_frame_set->delays.at(m_frame);
 
-    //signal connected to courtroom object, let it figure out what to do
-    done();
+  //the last frame stays up for its own delay before we're done
+  if (m_frame == f_frame_count - 1 && play_once)
+  {
+    done_timer->start(f_delay);
+    return;
   }
+
+  if (f_frame_count > 1)
+    frame_timer->start(f_delay);
+}
+
+void AOMovie::frame_change()
+{
+  ++m_frame;
+  show_frame();
+}
+
+void AOMovie::done_timer_done()
+{
+  this->stop();
+
+  //signal connected to courtroom object, let it figure out what to do
+  done();
 }
 
 void AOMovie::combo_resize(int w, int h)
 {
   QSize f_size(w, h);
+
+  //the frames are made for one size, so they only have to be made again if that changed
+  if (f_size == this->size())
+    return;
+
   this->resize(f_size);
-  m_movie->setScaledSize(f_size);
+
+  if (!m_frame_set.isNull())
+    fetch_frames();
+}
+
+void AOMovie::on_frames_ready(QString p_key)
+{
+  if (m_frame_set.isNull() || m_frame_set->complete || p_key != m_key)
+    return;
+
+  QSharedPointer<const frame_set_type> f_frame_set = ao_app->frame_cache->get_frames(m_path, this->size(), false);
+
+  if (f_frame_set.isNull())
+    return;
+
+  m_frame_set = f_frame_set;
+
+  frame_timer->stop();
+  m_frame = 0;
+  show_frame();
 }
@@ -2,7 +2,10 @@
 #define AOMOVIE_H
 
 #include <QLabel>
-#include <QMovie>
+#include <QTimer>
+#include <QSharedPointer>
+
+struct frame_set_type;
 
 class Courtroom;
 class AOApplication;
@@ -20,15 +23,30 @@ public:
   void stop();
 
 private:
-  QMovie *m_movie;
   AOApplication *ao_app;
   bool play_once = true;
 
+  //file and frames of whatever is playing, shared with the frame cache
+  QString m_path;
+  //the frame cache key m_frame_set is going to be complete under
+  QString m_key;
+  QSharedPointer<const frame_set_type> m_frame_set;
+  int m_frame = 0;
+
+  QTimer *frame_timer;
+  //runs out once the last frame of a play_once animation has been up long enough
+  QTimer *done_timer;
+
+  void fetch_frames();
+  void show_frame();
+
 signals:
   void done();
 
 private slots:
-  void frame_change(int n_frame);
+  void frame_change();
+  void done_timer_done();
+  void on_frames_ready(QString p_key);
 };
 
 #endif // AOMOVIE_H
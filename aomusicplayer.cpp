@@ -1,5 +1,7 @@
 #include "aomusicplayer.h"
 
+#include "file_functions.h"
+
 #include <string.h>
 
 #include <QDebug>
@@ -21,7 +23,17 @@ void AOMusicPlayer::play(QString p_song)
 
   QString f_path = ao_app->get_music_path(p_song);
 
-  m_stream = BASS_StreamCreateFile(FALSE, f_path.utf16(), 0, 0, BASS_STREAM_AUTOFREE | BASS_UNICODE | BASS_ASYNCFILE);
+  //the stream was freed when it stopped, so the data of the last song can go
+  if (is_packed_path(f_path))
+  {
+    m_data = get_packed_file(f_path);
+    m_stream = BASS_StreamCreateFile(TRUE, m_data.constData(), 0, m_data.size(), BASS_STREAM_AUTOFREE);
+  }
+  else
+  {
+    m_data.clear();
+    m_stream = BASS_StreamCreateFile(FALSE, f_path.utf16(), 0, 0, BASS_STREAM_AUTOFREE | BASS_UNICODE | BASS_ASYNCFILE);
+  }
 
   this->set_volume(m_volume);
 
@@ -5,6 +5,7 @@
 #include "aoapplication.h"
 
 #include <QWidget>
+#include <QByteArray>
 
 class AOMusicPlayer
 {
@@ -21,6 +22,8 @@ private:
 
   int m_volume = 0;
   HSTREAM m_stream;
+  //what m_stream plays from if the song is packed, it has to outlive the stream
+  QByteArray m_data;
 };
 
 #endif // AOMUSICPLAYER_H
@@ -4,16 +4,177 @@
 
 #include <QDebug>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AOPACKET_SSE2
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define AOPACKET_NEON
+#endif
+
+//'#', '$', '%' and '&' are consecutive in ASCII, so the escape table is indexed by (char - '#')
+static const ushort first_escaped_char = '#';
+static const ushort last_escaped_char = '&';
+
+static const char *const escape_tokens[] = {"<num>", "<dollar>", "<percent>", "<and>"};
+static const int escape_token_sizes[] = {5, 8, 9, 5};
+
+//returns the index of the first character at or after p_from that equals one of the four targets,
+//or p_size if there is none. the vector loops only find the block, the exact position is found by the scalar loop
+static int find_next_of(const QChar *p_data, int p_from, int p_size, ushort a, ushort b, ushort c, ushort d)
+{
+  const ushort *f_data = reinterpret_cast<const ushort*>(p_data);
+  int n_char = p_from;
+
+#if defined(AOPACKET_SSE2)
+  const __m128i f_a = _mm_set1_epi16(static_cast<short>(a));
+  const __m128i f_b = _mm_set1_epi16(static_cast<short>(b));
+  const __m128i f_c = _mm_set1_epi16(static_cast<short>(c));
+  const __m128i f_d = _mm_set1_epi16(static_cast<short>(d));
+
+  for ( ; n_char + 8 <= p_size ; n_char += 8)
+  {
+    __m128i f_block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(f_data + n_char));
+    __m128i f_match = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi16(f_block, f_a), _mm_cmpeq_epi16(f_block, f_b)),
+                                   _mm_or_si128(_mm_cmpeq_epi16(f_block, f_c), _mm_cmpeq_epi16(f_block, f_d)));
+
+    if (_mm_movemask_epi8(f_match) != 0)
+      break;
+  }
+#elif defined(AOPACKET_NEON)
+  const uint16x8_t f_a = vdupq_n_u16(a);
+  const uint16x8_t f_b = vdupq_n_u16(b);
+  const uint16x8_t f_c = vdupq_n_u16(c);
+  const uint16x8_t f_d = vdupq_n_u16(d);
+
+  for ( ; n_char + 8 <= p_size ; n_char += 8)
+  {
+    uint16x8_t f_block = vld1q_u16(f_data + n_char);
+    uint16x8_t f_match = vorrq_u16(vorrq_u16(vceqq_u16(f_block, f_a), vceqq_u16(f_block, f_b)),
+                                   vorrq_u16(vceqq_u16(f_block, f_c), vceqq_u16(f_block, f_d)));
+    uint64x2_t f_wide = vreinterpretq_u64_u16(f_match);
+
+    if ((vgetq_lane_u64(f_wide, 0) | vgetq_lane_u64(f_wide, 1)) != 0)
+      break;
+  }
+#endif
+
+  for ( ; n_char < p_size ; ++n_char)
+  {
+    ushort f_char = f_data[n_char];
+
+    if (f_char == a || f_char == b || f_char == c || f_char == d)
+      return n_char;
+  }
+
+  return p_size;
+}
+
+static int find_next_escaped(const QChar *p_data, int p_from, int p_size)
+{
+  return find_next_of(p_data, p_from, p_size, '#', '$', '%', '&');
+}
+
+static int find_next_token(const QChar *p_data, int p_from, int p_size)
+{
+  return find_next_of(p_data, p_from, p_size, '<', '<', '<', '<');
+}
+
+//p_first is the index of the first character that needs escaping
+static QString escape_chars(const QChar *p_data, int p_size, int p_first)
+{
+  QString f_result;
+  f_result.reserve(p_size + 16);
+
+  int f_copied = 0;
+  int f_pos = p_first;
+
+  while (f_pos < p_size)
+  {
+    f_result.append(p_data + f_copied, f_pos - f_copied);
+
+    int f_token = p_data[f_pos].unicode() - first_escaped_char;
+    f_result.append(QLatin1String(escape_tokens[f_token], escape_token_sizes[f_token]));
+
+    f_copied = f_pos + 1;
+    f_pos = find_next_escaped(p_data, f_copied, p_size);
+  }
+
+  f_result.append(p_data + f_copied, p_size - f_copied);
+
+  return f_result;
+}
+
+//p_first is the index of the first '<'
+static QString unescape_chars(const QChar *p_data, int p_size, int p_first)
+{
+  QString f_result;
+  f_result.reserve(p_size);
+
+  int f_copied = 0;
+  int f_pos = p_first;
+
+  while (f_pos < p_size)
+  {
+    int f_matched = -1;
+
+    for (int n_token = 0 ; n_token <= last_escaped_char - first_escaped_char ; ++n_token)
+    {
+      int f_token_size = escape_token_sizes[n_token];
+
+      if (f_pos + f_token_size > p_size)
+        continue;
+
+      const char *f_token = escape_tokens[n_token];
+      int n_char = 1;
+
+      while (n_char < f_token_size && p_data[f_pos + n_char].unicode() == static_cast<ushort>(f_token[n_char]))
+        ++n_char;
+
+      if (n_char == f_token_size)
+      {
+        f_matched = n_token;
+        break;
+      }
+    }
+
+    if (f_matched < 0)
+    {
+      //a lone '<' is kept as it is
+      f_pos = find_next_token(p_data, f_pos + 1, p_size);
+      continue;
+    }
+
+    f_result.append(p_data + f_copied, f_pos - f_copied);
+    f_result.append(QChar(first_escaped_char + f_matched));
+
+    f_copied = f_pos + escape_token_sizes[f_matched];
+    f_pos = find_next_token(p_data, f_copied, p_size);
+  }
+
+  f_result.append(p_data + f_copied, p_size - f_copied);
+
+  return f_result;
+}
+
 AOPacket::AOPacket(QString p_packet_string)
 {
-  QStringList packet_contents = p_packet_string.split("#");
+  m_packet_string = p_packet_string;
+  contents_built = false;
 
-  m_header = packet_contents.at(0);
+  const QChar *f_data = m_packet_string.constData();
+  int f_size = m_packet_string.size();
 
-  for(int n_string = 1 ; n_string < packet_contents.size() - 1 ; ++n_string)
+  for (int n_char = 0 ; n_char < f_size ; ++n_char)
   {
-    m_contents.append(packet_contents.at(n_string));
+    if (f_data[n_char] == QLatin1Char('#'))
+      m_separators.append(n_char);
   }
+
+  if (m_separators.isEmpty())
+    m_header = m_packet_string;
+  else
+    m_header = m_packet_string.left(m_separators.at(0));
 }
 
 AOPacket::AOPacket(QString p_header, QStringList &p_contents)
@@ -27,11 +188,64 @@ AOPacket::~AOPacket()
 
 }
 
+int AOPacket::get_field_count()
+{
+  if (contents_built)
+    return m_contents.size();
+
+  //whatever follows the last # is not a field, just like the header isn't
+  if (m_separators.size() < 2)
+    return 0;
+
+  return m_separators.size() - 1;
+}
+
+QStringRef AOPacket::get_raw_field(int p_field)
+{
+  int f_start = m_separators.at(p_field) + 1;
+  int f_end = m_separators.at(p_field + 1);
+
+  return m_packet_string.midRef(f_start, f_end - f_start);
+}
+
+QString AOPacket::get_field(int p_field)
+{
+  if (p_field < 0 || p_field >= get_field_count())
+    return "";
+
+  if (contents_built)
+    return m_contents.at(p_field);
+
+  if (decode_pending)
+    return decode_field(get_raw_field(p_field));
+  else
+    return get_raw_field(p_field).toString();
+}
+
+QStringList &AOPacket::get_contents()
+{
+  if (contents_built)
+    return m_contents;
+
+  int f_field_count = get_field_count();
+  m_contents.reserve(f_field_count);
+
+  for (int n_field = 0 ; n_field < f_field_count ; ++n_field)
+  {
+    m_contents.append(get_field(n_field));
+  }
+
+  contents_built = true;
+  decode_pending = false;
+
+  return m_contents;
+}
+
 QString AOPacket::to_string()
 {
   QString f_string = m_header;
 
-  for (QString i_string : m_contents)
+  for (QString i_string : get_contents())
   {
     f_string += ("#" + i_string);
   }
@@ -61,25 +275,55 @@ void AOPacket::decrypt_header(unsigned int p_key)
 
 void AOPacket::net_encode()
 {
-  for (int n_element = 0 ; n_element < m_contents.size() ; ++n_element)
-  {
-    QString f_element = m_contents.at(n_element);
-    f_element.replace("#", "<num>").replace("%", "<percent>").replace("$", "<dollar>").replace("&", "<and>");
+  QStringList &f_contents = get_contents();
 
-    m_contents.removeAt(n_element);
-    m_contents.insert(n_element, f_element);
+  for (int n_element = 0 ; n_element < f_contents.size() ; ++n_element)
+  {
+    f_contents[n_element] = encode_field(f_contents.at(n_element));
   }
 }
 
 void AOPacket::net_decode()
 {
-  for (int n_element = 0 ; n_element < m_contents.size() ; ++n_element)
+  //nothing has been read yet, so defer the work to get_field()
+  if (!contents_built)
   {
-    QString f_element = m_contents.at(n_element);
-    f_element.replace("<num>", "#").replace("<percent>", "%").replace("<dollar>", "$").replace("<and>", "&");
+    decode_pending = true;
+    return;
+  }
 
-    m_contents.removeAt(n_element);
-    m_contents.insert(n_element, f_element);
+  for (int n_element = 0 ; n_element < m_contents.size() ; ++n_element)
+  {
+    m_contents[n_element] = decode_field(m_contents.at(n_element));
   }
 }
 
+QString AOPacket::encode_field(const QString &p_field)
+{
+  int f_first = find_next_escaped(p_field.constData(), 0, p_field.size());
+
+  if (f_first == p_field.size())
+    return p_field;
+
+  return escape_chars(p_field.constData(), p_field.size(), f_first);
+}
+
+QString AOPacket::decode_field(const QString &p_field)
+{
+  int f_first = find_next_token(p_field.constData(), 0, p_field.size());
+
+  if (f_first == p_field.size())
+    return p_field;
+
+  return unescape_chars(p_field.constData(), p_field.size(), f_first);
+}
+
+QString AOPacket::decode_field(const QStringRef &p_field)
+{
+  int f_first = find_next_token(p_field.unicode(), 0, p_field.size());
+
+  if (f_first == p_field.size())
+    return p_field.toString();
+
+  return unescape_chars(p_field.unicode(), p_field.size(), f_first);
+}
@@ -3,6 +3,8 @@
 
 #include <QString>
 #include <QStringList>
+#include <QStringRef>
+#include <QVarLengthArray>
 
 class AOPacket
 {
@@ -12,7 +14,17 @@ public:
   ~AOPacket();
 
   QString get_header() {return m_header;}
-  QStringList &get_contents() {return m_contents;}
+
+  //fields are read straight out of the packet string. after net_decode(), only the fields
+  //that are actually read get unescaped
+  int get_field_count();
+  QString get_field(int p_field);
+
+  //builds the full field list on first use, prefer get_field() on hot paths
+  QStringList &get_contents();
+
+  //the packet as it was received, without the terminating %
+  QString get_raw_string() {return m_packet_string;}
   QString to_string();
 
   void encrypt_header(unsigned int p_key);
@@ -24,8 +36,25 @@ public:
 private:
   bool encrypted = false;
 
+  //false as long as the fields only exist as offsets into m_packet_string
+  bool contents_built = true;
+  //net_decode() was called before the field list was built
+  bool decode_pending = false;
+
+  QString m_packet_string;
+  //position of every # in m_packet_string. an MS packet fits in the inline storage
+  QVarLengthArray<int, 32> m_separators;
+
   QString m_header;
   QStringList m_contents;
+
+  QStringRef get_raw_field(int p_field);
+
+  //implementation of these is a single pass per field that returns the input untouched
+  //if there is nothing to escape
+  static QString encode_field(const QString &p_field);
+  static QString decode_field(const QString &p_field);
+  static QString decode_field(const QStringRef &p_field);
 };
 
 #endif // AOPACKET_H
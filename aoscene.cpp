@@ -3,6 +3,7 @@
 #include "courtroom.h"
 
 #include "file_functions.h"
+#include "image_functions.h"
 
 #include <QDebug>
 
@@ -14,23 +15,23 @@ AOScene::AOScene(QWidget *parent, AOApplication *p_ao_app) : QLabel(parent)
 
 void AOScene::set_image(QString p_image)
 {
-  QString background_path = ao_app->get_background_path() + p_image + ".png";
-  QString animated_background_path = ao_app->get_background_path() + p_image + ".gif";
+  QString background_path = resolve_path(ao_app->get_background_path() + p_image + ".png");
+  QString animated_background_path = resolve_path(ao_app->get_background_path() + p_image + ".gif");
   QString default_path = ao_app->get_default_background_path() + p_image;
 
-  QPixmap background(background_path);
-  QPixmap animated_background(animated_background_path);
-  QPixmap default_bg(default_path);
-
-  int w = this->width();
-  int h = this->height();
+  QString final_path;
 
   if (file_exists(animated_background_path))
-    this->setPixmap(animated_background.scaled(w, h));
+    final_path = animated_background_path;
   else if (file_exists(background_path))
-    this->setPixmap(background.scaled(w, h));
+    final_path = background_path;
   else
-    this->setPixmap(default_bg.scaled(w, h));
+    final_path = default_path;
+
+  //only the one that's shown is read, and straight at the size it's shown at
+  QImage f_image = read_scaled_image(final_path, this->size(), ao_app->get_smooth_scaling());
+
+  this->setPixmap(QPixmap::fromImage(f_image));
 }
 
 void AOScene::set_legacy_desk(QString p_image)
@@ -38,15 +39,19 @@ void AOScene::set_legacy_desk(QString p_image)
   //vanilla desks vary in both width and height. in order to make that work with viewport rescaling,
   //some INTENSE math is needed.
 
-  QString desk_path = ao_app->get_background_path() + p_image;
+  QString desk_path = resolve_path(ao_app->get_background_path() + p_image);
   QString default_path = ao_app->get_default_background_path() + p_image;
 
-  QPixmap f_desk;
+  QString final_path;
 
   if (file_exists(desk_path))
-    f_desk.load(desk_path);
+    final_path = desk_path;
   else
-    f_desk.load(default_path);
+    final_path = default_path;
+
+  //the height it ends up at depends on the one it comes in, which the header already tells
+  //an unreadable desk is taken as an empty one
+  QSize f_desk = read_image_size(final_path).expandedTo(QSize(0, 0));
 
   int vp_width = m_parent->width();
   int vp_height = m_parent->height();
@@ -62,5 +67,5 @@ void AOScene::set_legacy_desk(QString p_image)
   //this->resize(final_w, final_h);
   //this->setPixmap(f_desk.scaled(final_w, final_h));
   this->resize(vp_width, final_h);
-  this->setPixmap(f_desk.scaled(vp_width, final_h));
+  this->setPixmap(QPixmap::fromImage(read_scaled_image(final_path, QSize(vp_width, final_h), ao_app->get_smooth_scaling())));
 }
@@ -1,5 +1,7 @@
 #include "aosfxplayer.h"
 
+#include "file_functions.h"
+
 #include <string.h>
 
 #include <QDebug>
@@ -10,20 +12,34 @@ AOSfxPlayer::AOSfxPlayer(QWidget *parent, AOApplication *p_ao_app)
   ao_app = p_ao_app;
 }
 
-void AOSfxPlayer::play(QString p_sfx, QString p_char)
+AOSfxPlayer::~AOSfxPlayer()
 {
+  //the stream may still be reading from m_data
   BASS_ChannelStop(m_stream);
+  BASS_StreamFree(m_stream);
+}
 
-  p_sfx = p_sfx.toLower();
+void AOSfxPlayer::play(QString p_sfx, QString p_char)
+{
+  BASS_ChannelStop(m_stream);
 
   QString f_path;
 
   if (p_char != "")
-    f_path = ao_app->get_character_path(p_char) + p_sfx;
+    f_path = resolve_path(ao_app->get_character_path(p_char) + p_sfx);
   else
-    f_path = ao_app->get_sounds_path() + p_sfx;
+    f_path = resolve_path(ao_app->get_sounds_path() + p_sfx);
 
-  m_stream = BASS_StreamCreateFile(FALSE, f_path.utf16(), 0, 0, BASS_STREAM_AUTOFREE | BASS_UNICODE | BASS_ASYNCFILE);
+  if (is_packed_path(f_path))
+  {
+    m_data = get_packed_file(f_path);
+    m_stream = BASS_StreamCreateFile(TRUE, m_data.constData(), 0, m_data.size(), BASS_STREAM_AUTOFREE);
+  }
+  else
+  {
+    m_data.clear();
+    m_stream = BASS_StreamCreateFile(FALSE, f_path.utf16(), 0, 0, BASS_STREAM_AUTOFREE | BASS_UNICODE | BASS_ASYNCFILE);
+  }
 
   set_volume(m_volume);
 
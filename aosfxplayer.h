@@ -5,11 +5,13 @@
 #include "aoapplication.h"
 
 #include <QWidget>
+#include <QByteArray>
 
 class AOSfxPlayer
 {
 public:
   AOSfxPlayer(QWidget *parent, AOApplication *p_ao_app);
+  ~AOSfxPlayer();
 
   void play(QString p_sfx, QString p_char = "");
   void stop();
@@ -20,7 +22,9 @@ private:
   AOApplication *ao_app;
 
   int m_volume = 0;
-  HSTREAM m_stream;
+  HSTREAM m_stream = 0;
+  //what m_stream plays from if the sound is packed, it has to outlive the stream
+  QByteArray m_data;
 };
 
 #endif // AOSFXPLAYER_H
@@ -0,0 +1,521 @@
+#include "assetindex.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QResource>
+#include <QDebug>
+
+#include <algorithm>
+
+//where the entries of every .aopack show up, see mkpack/
+static const QString pack_map_root = "/aopack";
+static const QString pack_root = ":/aopack/";
+
+//every watch is a kernel handle, and inotify only hands out so many of them per user
+static const int max_watched_folders = 1024;
+//how long the listing of a folder without a watch is trusted to be missing something, in milliseconds
+static const qint64 unwatched_listing_lifetime = 5000;
+//entries in m_resolved
+static const int max_resolved_paths = 4096;
+
+class AssetIndexBuildTask : public QRunnable
+{
+public:
+  AssetIndexBuildTask(AssetIndex *p_index, QString p_root)
+  {
+    m_index = p_index;
+    m_root = p_root;
+  }
+
+  void run()
+  {
+    QSet<QString> f_visited;
+
+    AssetIndex::scan_directory(m_root, m_index->m_built_entries, m_index->m_built_directories, f_visited);
+
+    QMetaObject::invokeMethod(m_index, "on_build_finished", Qt::QueuedConnection);
+  }
+
+private:
+  AssetIndex *m_index;
+  QString m_root;
+};
+
+AssetIndex::AssetIndex(QString p_root, QObject *parent) : QObject(parent)
+{
+  m_root = normalize(p_root);
+  m_root_path = QDir::cleanPath(p_root);
+
+  m_resolved.setMaxCost(max_resolved_paths);
+  m_clock.start();
+
+  m_watcher = new QFileSystemWatcher(this);
+
+  connect(m_watcher, SIGNAL(directoryChanged(QString)), this, SLOT(on_directory_changed(QString)));
+}
+
+AssetIndex::~AssetIndex()
+{
+  //the build task writes into this object, it has to be done before we're gone
+  QThreadPool::globalInstance()->waitForDone();
+
+  for (QString i_pack : m_packs)
+    QResource::unregisterResource(i_pack, pack_map_root);
+}
+
+void AssetIndex::build()
+{
+  if (!m_build_running.testAndSetOrdered(0, 1))
+    return;
+
+  m_built_entries.clear();
+  m_built_directories.clear();
+
+  QThreadPool::globalInstance()->start(new AssetIndexBuildTask(this, m_root));
+}
+
+void AssetIndex::on_build_finished()
+{
+  {
+    QWriteLocker locker(&m_lock);
+
+    m_entries = m_built_entries;
+    m_ready = true;
+  }
+
+  m_built_entries.clear();
+
+  watch_directories(m_built_directories);
+
+  qDebug() << "asset index: indexed" << m_entries.size() << "folders under" << m_root << "and watching" << m_watched.size();
+
+  m_built_directories.clear();
+  m_build_running.storeRelease(0);
+}
+
+AssetIndex::lookup_result AssetIndex::lookup(QString p_path)
+{
+  QString f_path = normalize(p_path);
+
+  if (f_path != m_root && !f_path.startsWith(m_root + "/"))
+    return UNKNOWN;
+
+  QReadLocker locker(&m_lock);
+
+  if (!m_ready)
+    return UNKNOWN;
+
+  if (m_entries.contains(f_path))
+    return FOUND_DIRECTORY;
+
+  int f_slash = f_path.lastIndexOf("/");
+
+  QHash<QString, QSet<QString>>::const_iterator f_dir = m_entries.constFind(f_path.left(f_slash));
+
+  if (f_dir != m_entries.constEnd() && f_dir->contains(f_path.mid(f_slash + 1)))
+    return FOUND_FILE;
+
+  //the nearest folder the index knows is the one that would have seen the entry appear
+  QString f_parent = f_path.left(f_slash);
+
+  while (!m_entries.contains(f_parent) && f_parent.size() > m_root.size())
+    f_parent = f_parent.left(f_parent.lastIndexOf("/"));
+
+  if (m_watched.contains(f_parent))
+    return MISSING;
+
+  return UNKNOWN;
+}
+
+QString AssetIndex::resolve(QString p_path)
+{
+#if defined(Q_OS_WIN) || defined(Q_OS_MAC)
+  //the file system takes care of case, so there's only something to do if a pack could have the file
+  if (m_packs.isEmpty())
+    return p_path;
+#endif
+
+  QMutexLocker locker(&m_resolve_lock);
+
+  QString *f_cached = m_resolved.object(p_path);
+
+  if (f_cached != nullptr)
+    return *f_cached;
+
+  //somebody appended to a folder that is only in a pack. entries are stored lowercase
+  if (p_path.startsWith(pack_root))
+  {
+    QString f_packed = p_path.toLower();
+    m_resolved.insert(p_path, new QString(f_packed));
+    return f_packed;
+  }
+
+  QString f_path = QDir::cleanPath(p_path);
+
+  if (f_path == m_root_path || !f_path.startsWith(m_root_path + "/"))
+  {
+    m_resolved.insert(p_path, new QString(p_path));
+    return p_path;
+  }
+
+  quint64 f_generation = m_folder_generation;
+  locker.unlock();
+
+  QString f_relative = f_path.mid(m_root_path.size() + 1);
+  bool f_found;
+
+#if defined(Q_OS_WIN) || defined(Q_OS_MAC)
+  QString f_resolved = p_path;
+  lookup_result f_result = lookup(p_path);
+
+  if (f_result == UNKNOWN)
+    f_found = QFileInfo::exists(p_path);
+  else
+    f_found = f_result != MISSING;
+#else
+  QString f_resolved = resolve_case(f_relative, f_found);
+
+  if (p_path.endsWith("/"))
+    f_resolved += "/";
+#endif
+
+  //loose files always win, packs only fill in what isn't there
+  if (!f_found && !m_packs.isEmpty())
+  {
+    QString f_packed = pack_root + f_relative.toLower();
+
+    if (QFileInfo::exists(f_packed))
+    {
+      f_resolved = p_path.endsWith("/") ? f_packed + "/" : f_packed;
+      f_found = true;
+    }
+  }
+
+  locker.relock();
+
+  //a walk through a folder that changed meanwhile may have gone by the old names
+  if (f_found && f_generation == m_folder_generation)
+    m_resolved.insert(p_path, new QString(f_resolved));
+
+  return f_resolved;
+}
+
+//m_resolve_lock must not be held, see get_folder_names
+QString AssetIndex::resolve_case(QString p_relative, bool &r_found)
+{
+  QStringList f_parts = p_relative.split("/");
+  QString f_resolved = m_root_path;
+
+  r_found = true;
+
+  for (int n_part = 0 ; n_part < f_parts.size() ; ++n_part)
+  {
+    QString f_part;
+
+    if (!find_name(f_resolved, f_parts.at(n_part), f_part))
+    {
+      //nothing further down can exist either
+      r_found = false;
+      return f_resolved + "/" + QStringList(f_parts.mid(n_part)).join("/");
+    }
+
+    f_resolved += "/" + f_part;
+  }
+
+  return f_resolved;
+}
+
+//m_resolve_lock must not be held, see get_folder_names
+bool AssetIndex::find_name(QString p_dir, QString p_name, QString &r_real_name)
+{
+  for (int n_try = 0 ; n_try < 2 ; ++n_try)
+  {
+    folder_names_type f_names = get_folder_names(p_dir);
+
+    //an exact match wins, that's what the file would have been opened as before
+    if (f_names.names.contains(p_name))
+    {
+      r_real_name = p_name;
+      return true;
+    }
+
+    QHash<QString, QString>::const_iterator f_real = f_names.folded.constFind(p_name.toLower());
+
+    if (f_real != f_names.folded.constEnd())
+    {
+      r_real_name = f_real.value();
+      return true;
+    }
+
+    //nobody tells us when a folder without a watch changes, so a listing that's been around for a while is
+    //made again before the name is given up on
+    if (n_try > 0 || m_clock.elapsed() - f_names.listed_at < unwatched_listing_lifetime || is_watched(p_dir))
+      return false;
+
+    QMutexLocker locker(&m_resolve_lock);
+    QHash<QString, folder_names_type>::iterator f_stale = m_folder_names.find(p_dir);
+
+    //unless another thread listed it again already
+    if (f_stale != m_folder_names.end() && f_stale->listed_at == f_names.listed_at)
+      m_folder_names.erase(f_stale);
+  }
+
+  return false;
+}
+
+void AssetIndex::mount_packs()
+{
+  QDir f_root(m_root_path);
+  QStringList f_packs = f_root.entryList(QStringList() << "*.aopack", QDir::Files, QDir::Name);
+
+  for (QString i_pack : f_packs)
+  {
+    QString f_path = f_root.filePath(i_pack);
+
+    //maps the file where the platform allows it, the entries are then read straight out of memory
+    if (QResource::registerResource(f_path, pack_map_root))
+      m_packs.append(f_path);
+    else
+      qDebug() << "W: could not mount asset pack" << f_path;
+  }
+
+  if (!m_packs.isEmpty())
+    qDebug() << "asset index: mounted" << m_packs;
+}
+
+//takes m_resolve_lock only to look the folder up and to store it, the listing itself is done without it
+//two threads can end up listing the same folder, the first one to store it wins
+AssetIndex::folder_names_type AssetIndex::get_folder_names(QString p_dir)
+{
+  QMutexLocker locker(&m_resolve_lock);
+  QHash<QString, folder_names_type>::const_iterator f_names = m_folder_names.constFind(p_dir);
+
+  if (f_names != m_folder_names.constEnd())
+    return f_names.value();
+
+  quint64 f_generation = m_folder_generation;
+  locker.unlock();
+
+  folder_names_type f_new_names;
+  f_new_names.listed_at = m_clock.elapsed();
+
+  QStringList f_list = QDir(p_dir).entryList(QDir::Files | QDir::Dirs | QDir::Hidden | QDir::NoDotAndDotDot);
+
+  for (QString i_name : f_list)
+  {
+    f_new_names.names.insert(i_name);
+
+    //with two names that only differ in case, the lowercase one is the one the client always used
+    QString f_folded = i_name.toLower();
+
+    if (!f_new_names.folded.contains(f_folded) || i_name == f_folded)
+      f_new_names.folded.insert(f_folded, i_name);
+  }
+
+  locker.relock();
+
+  //the watcher dropped listings while we were at it, this one could be from before the change
+  if (f_generation != m_folder_generation)
+    return f_new_names;
+
+  f_names = m_folder_names.constFind(p_dir);
+
+  if (f_names != m_folder_names.constEnd())
+    return f_names.value();
+
+  return m_folder_names.insert(p_dir, f_new_names).value();
+}
+
+void AssetIndex::forget_folder_names(QString p_dir)
+{
+  QMutexLocker locker(&m_resolve_lock);
+
+  //any path could have gone through this folder
+  m_resolved.clear();
+  ++m_folder_generation;
+
+  QStringList f_keys = m_folder_names.keys();
+
+  for (QString i_key : f_keys)
+  {
+    if (i_key == p_dir || i_key.startsWith(p_dir + "/"))
+      m_folder_names.remove(i_key);
+  }
+}
+
+void AssetIndex::watch_directories(QStringList p_dirs)
+{
+  //shallow folders first, those are the ones new characters, backgrounds and songs show up in
+  std::stable_sort(p_dirs.begin(), p_dirs.end(), [](const QString &a, const QString &b)
+  {
+    return a.count("/") < b.count("/");
+  });
+
+  QStringList f_dirs = p_dirs.mid(0, qMax(0, max_watched_folders - m_watched.size()));
+
+  if (f_dirs.isEmpty())
+    return;
+
+  QSet<QString> f_rejected = m_watcher->addPaths(f_dirs).toSet();
+
+  if (!f_rejected.isEmpty())
+    qDebug() << "W: asset index: could not watch" << f_rejected.size() << "folders, lookups in those go to the file system";
+
+  QWriteLocker locker(&m_lock);
+
+  for (QString i_dir : f_dirs)
+  {
+    if (!f_rejected.contains(i_dir))
+      m_watched.insert(normalize(i_dir));
+  }
+}
+
+bool AssetIndex::is_watched(QString p_dir)
+{
+  QReadLocker locker(&m_lock);
+
+  return m_watched.contains(normalize(p_dir));
+}
+
+void AssetIndex::count_lookup(bool p_answered, bool p_exists)
+{
+  m_lookups.fetchAndAddRelaxed(1);
+
+  if (p_answered)
+    m_stats_avoided.fetchAndAddRelaxed(1);
+
+  if (p_exists)
+    m_hits.fetchAndAddRelaxed(1);
+}
+
+void AssetIndex::dump_stats()
+{
+  qDebug() << "asset index stats (lookups, hits, stat calls avoided):"
+           << m_lookups.loadAcquire() << m_hits.loadAcquire() << m_stats_avoided.loadAcquire();
+}
+
+//the watcher only says that something in the folder changed, so the folder is listed again
+//m_entries is only ever written on this thread, so reading it here needs no lock
+void AssetIndex::on_directory_changed(QString p_path)
+{
+  QString f_path = normalize(p_path);
+
+  forget_folder_names(QDir::cleanPath(p_path));
+
+  QHash<QString, QSet<QString>> f_new_entries;
+  QStringList f_new_directories;
+  //folders directly inside p_path
+  QSet<QString> f_subdirs;
+
+  bool f_exists = QFileInfo(p_path).isDir();
+
+  if (f_exists)
+  {
+    QSet<QString> f_files;
+    QFileInfoList f_list = QDir(p_path).entryInfoList(QDir::Files | QDir::Dirs | QDir::Hidden | QDir::NoDotAndDotDot);
+
+    for (QFileInfo i_info : f_list)
+    {
+      if (!i_info.isDir())
+      {
+        f_files.insert(normalize(i_info.fileName()));
+        continue;
+      }
+
+      QString f_subdir = normalize(i_info.filePath());
+      f_subdirs.insert(f_subdir);
+
+      //folders we already know about have their own watch
+      if (!m_entries.contains(f_subdir))
+      {
+        QSet<QString> f_visited;
+        scan_directory(i_info.filePath(), f_new_entries, f_new_directories, f_visited);
+      }
+    }
+
+    f_new_entries.insert(f_path, f_files);
+  }
+
+  QWriteLocker locker(&m_lock);
+
+  //a folder that is gone takes everything below it with it
+  QStringList f_keys = m_entries.keys();
+
+  for (QString i_key : f_keys)
+  {
+    if (i_key == f_path)
+    {
+      if (!f_exists)
+      {
+        m_entries.remove(i_key);
+        m_watched.remove(i_key);
+      }
+
+      continue;
+    }
+
+    if (!i_key.startsWith(f_path + "/"))
+      continue;
+
+    QString f_child = f_path + "/" + i_key.mid(f_path.size() + 1).section("/", 0, 0);
+
+    if (!f_subdirs.contains(f_child))
+    {
+      m_entries.remove(i_key);
+      m_watched.remove(i_key);
+    }
+  }
+
+  for (QHash<QString, QSet<QString>>::const_iterator i_dir = f_new_entries.constBegin() ; i_dir != f_new_entries.constEnd() ; ++i_dir)
+    m_entries.insert(i_dir.key(), i_dir.value());
+
+  locker.unlock();
+
+  watch_directories(f_new_directories);
+}
+
+QString AssetIndex::normalize(QString p_path)
+{
+  QString f_path = QDir::cleanPath(p_path);
+
+  //these file systems don't care about case, so neither does the index
+#if defined(Q_OS_WIN) || defined(Q_OS_MAC)
+  f_path = f_path.toLower();
+#endif
+
+  return f_path;
+}
+
+void AssetIndex::scan_directory(QString p_dir, QHash<QString, QSet<QString>> &r_entries,
+                                QStringList &r_directories, QSet<QString> &r_visited)
+{
+  QString f_key = normalize(p_dir);
+
+  //symlinks can make the tree loop back on itself
+  QString f_canonical = QFileInfo(p_dir).canonicalFilePath();
+
+  if (f_canonical == "" || r_visited.contains(f_canonical))
+    return;
+
+  r_visited.insert(f_canonical);
+
+  QSet<QString> f_files;
+  QDir f_dir(p_dir);
+
+  QFileInfoList f_list = f_dir.entryInfoList(QDir::Files | QDir::Dirs | QDir::Hidden | QDir::NoDotAndDotDot);
+
+  for (QFileInfo i_info : f_list)
+  {
+    if (i_info.isDir())
+      scan_directory(i_info.filePath(), r_entries, r_directories, r_visited);
+    else
+      f_files.insert(normalize(i_info.fileName()));
+  }
+
+  r_entries.insert(f_key, f_files);
+  r_directories.append(p_dir);
+}
@@ -0,0 +1,123 @@
+#ifndef ASSETINDEX_H
+#define ASSETINDEX_H
+
+#include <QObject>
+#include <QHash>
+#include <QCache>
+#include <QSet>
+#include <QStringList>
+#include <QReadWriteLock>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QFileSystemWatcher>
+
+//in-memory listing of everything under base/, so file_exists and dir_exists don't have to stat
+//it is built on the global thread pool at startup and kept current with a QFileSystemWatcher
+//until the first build is done (or for paths outside of base/) lookups report unknown and the caller has to stat
+//only so many folders get a watch, the shallow ones first. anything missing from a folder without one is
+//reported as unknown as well, as it could have shown up since
+//lookups are thread safe
+class AssetIndex : public QObject
+{
+  Q_OBJECT
+
+public:
+  enum lookup_result
+  {
+    UNKNOWN = 0,
+    MISSING,
+    FOUND_FILE,
+    FOUND_DIRECTORY
+  };
+
+  AssetIndex(QString p_root, QObject *parent = nullptr);
+  ~AssetIndex();
+
+  void build();
+
+  //makes the files in every .aopack in the root available under :/aopack/
+  void mount_packs();
+
+  lookup_result lookup(QString p_path);
+
+  //p_path with every part below the root spelled the way it is on disk, ignoring case
+  //parts that don't exist in any case are kept as they are. if the file isn't there at all but one of the packs has it,
+  //the path of the packed file is returned instead
+  QString resolve(QString p_path);
+
+  //answered from the index, as opposed to the ones the caller had to stat for
+  void count_lookup(bool p_answered, bool p_exists);
+  void dump_stats();
+
+private:
+  //normalized root, every indexed path starts with this
+  QString m_root;
+
+  //normalized directory -> normalized names of the files directly in it
+  QHash<QString, QSet<QString>> m_entries;
+  //normalized folders the watcher actually took, what m_entries says about them is current
+  QSet<QString> m_watched;
+  bool m_ready = false;
+  QReadWriteLock m_lock;
+
+  //the first build, handed over from the worker to the GUI thread
+  QHash<QString, QSet<QString>> m_built_entries;
+  QStringList m_built_directories;
+  QAtomicInt m_build_running;
+
+  QFileSystemWatcher *m_watcher;
+
+  //real names of the entries of a folder, listed the first time something in it is resolved
+  struct folder_names_type
+  {
+    QSet<QString> names;
+    //lowercase name -> real name
+    QHash<QString, QString> folded;
+    //m_clock at the time of listing
+    qint64 listed_at = 0;
+  };
+
+  //root as given, with its case intact
+  QString m_root_path;
+
+  //paths that resolved to something that exists, so those are only ever walked once
+  //the ones that didn't are walked again every time, the file could have shown up since
+  QCache<QString, QString> m_resolved;
+  //real folder path -> the names in it
+  QHash<QString, folder_names_type> m_folder_names;
+  //guards the two above only, folders are listed and stat'ed without it so the scan threads don't queue up on it
+  QMutex m_resolve_lock;
+  //bumped whenever the watcher drops listings, anything walked before that isn't kept
+  quint64 m_folder_generation = 0;
+  QElapsedTimer m_clock;
+
+  //mounted .aopack files
+  QStringList m_packs;
+
+  QString resolve_case(QString p_relative, bool &r_found);
+  bool find_name(QString p_dir, QString p_name, QString &r_real_name);
+  folder_names_type get_folder_names(QString p_dir);
+  void forget_folder_names(QString p_dir);
+
+  //adds watches for as many of p_dirs as the budget allows
+  void watch_directories(QStringList p_dirs);
+  bool is_watched(QString p_dir);
+
+  QAtomicInt m_lookups;
+  QAtomicInt m_hits;
+  QAtomicInt m_stats_avoided;
+
+  friend class AssetIndexBuildTask;
+
+  static QString normalize(QString p_path);
+  //adds p_dir and everything below it. r_directories gets the real paths for the watcher
+  static void scan_directory(QString p_dir, QHash<QString, QSet<QString>> &r_entries,
+                             QStringList &r_directories, QSet<QString> &r_visited);
+
+private slots:
+  void on_build_finished();
+  void on_directory_changed(QString p_path);
+};
+
+#endif // ASSETINDEX_H
@@ -0,0 +1,249 @@
+#include "assetscanner.h"
+
+#include "aoapplication.h"
+#include "file_functions.h"
+
+#include <QRunnable>
+#include <QAtomicInt>
+#include <QStringList>
+#include <QDebug>
+
+//small enough that every thread gets a share of a typical list, big enough that the tasks aren't all overhead
+static const int scan_chunk_size = 64;
+
+enum asset_scan_kind
+{
+  SCAN_CHARS = 0,
+  SCAN_MUSIC,
+  SCAN_EVIDENCE
+};
+
+struct asset_scan_job_type
+{
+  QStringList chars;
+  QStringList music;
+  QStringList evidence;
+
+  //resolved on the GUI thread, the workers only append names to them
+  QString character_path;
+  QString demothings_path;
+  QString music_path;
+  QString evidence_path;
+
+  //one byte per entry rather than a bit, so that no two tasks ever write to the same byte
+  QVector<char> char_inis;
+  QVector<char> char_icons;
+  QVector<char> music_found;
+  QVector<char> evidence_found;
+
+  QAtomicInt remaining;
+  QAtomicInt cancelled;
+};
+
+class AssetScanTask : public QRunnable
+{
+public:
+  AssetScanTask(AssetScanner *p_scanner, QSharedPointer<asset_scan_job_type> p_job, asset_scan_kind p_kind, int p_begin, int p_end)
+  {
+    m_scanner = p_scanner;
+    m_job = p_job;
+    m_kind = p_kind;
+    m_begin = p_begin;
+    m_end = p_end;
+
+    //taken here on the GUI thread, the vectors are never resized once the tasks exist
+    if (p_kind == SCAN_CHARS)
+    {
+      m_found = p_job->char_inis.data();
+      m_icons = p_job->char_icons.data();
+    }
+    else if (p_kind == SCAN_MUSIC)
+      m_found = p_job->music_found.data();
+    else
+      m_found = p_job->evidence_found.data();
+  }
+
+  void run()
+  {
+    for (int n_entry = m_begin ; n_entry < m_end ; ++n_entry)
+    {
+      if (m_job->cancelled.loadAcquire())
+        break;
+
+      if (m_kind == SCAN_CHARS)
+      {
+        QString f_char = m_job->chars.at(n_entry);
+
+        m_found[n_entry] = file_exists(resolve_path(m_job->character_path + f_char + "/char.ini"));
+        m_icons[n_entry] = file_exists(resolve_path(m_job->character_path + f_char + "/char_icon.png")) ||
+                           file_exists(resolve_path(m_job->demothings_path + f_char + "_char_icon.png"));
+      }
+      else if (m_kind == SCAN_MUSIC)
+        m_found[n_entry] = file_exists(resolve_path(m_job->music_path + m_job->music.at(n_entry)));
+      else
+        m_found[n_entry] = file_exists(resolve_path(m_job->evidence_path + m_job->evidence.at(n_entry)));
+    }
+
+    //the scanner waits for its pool before it goes away, so it is still there
+    if (m_job->remaining.fetchAndAddOrdered(-1) == 1)
+      QMetaObject::invokeMethod(m_scanner, "on_scan_finished", Qt::QueuedConnection);
+  }
+
+private:
+  AssetScanner *m_scanner;
+  QSharedPointer<asset_scan_job_type> m_job;
+  asset_scan_kind m_kind;
+  int m_begin;
+  int m_end;
+
+  char *m_found = nullptr;
+  char *m_icons = nullptr;
+};
+
+static QBitArray to_bits(const QVector<char> &p_found)
+{
+  QBitArray f_bits(p_found.size());
+
+  for (int n_entry = 0 ; n_entry < p_found.size() ; ++n_entry)
+    f_bits.setBit(n_entry, p_found.at(n_entry) != 0);
+
+  return f_bits;
+}
+
+AssetScanner::AssetScanner(AOApplication *p_ao_app, QObject *parent) : QObject(parent)
+{
+  ao_app = p_ao_app;
+}
+
+AssetScanner::~AssetScanner()
+{
+  cancel();
+  m_pool.waitForDone();
+}
+
+void AssetScanner::scan(const QVector<char_type> &p_chars, const QVector<QString> &p_music, const QVector<evi_type> &p_evidence)
+{
+  cancel();
+
+  m_ready = false;
+  m_char_inis.clear();
+  m_char_icons.clear();
+  m_music.clear();
+  m_evidence.clear();
+
+  QSharedPointer<asset_scan_job_type> f_job(new asset_scan_job_type);
+
+  for (char_type i_char : p_chars)
+    f_job->chars.append(i_char.name);
+
+  for (QString i_song : p_music)
+    f_job->music.append(i_song);
+
+  for (evi_type i_evi : p_evidence)
+    f_job->evidence.append(i_evi.image);
+
+  f_job->character_path = ao_app->get_base_path() + "characters/";
+  f_job->demothings_path = ao_app->get_demothings_path();
+  f_job->music_path = ao_app->get_base_path() + "sounds/music/";
+  f_job->evidence_path = ao_app->get_evidence_path();
+
+  //sized up front, the tasks must never cause a reallocation
+  f_job->char_inis.fill(0, f_job->chars.size());
+  f_job->char_icons.fill(0, f_job->chars.size());
+  f_job->music_found.fill(0, f_job->music.size());
+  f_job->evidence_found.fill(0, f_job->evidence.size());
+
+  QVector<AssetScanTask*> f_tasks;
+  const int f_sizes[] = {f_job->chars.size(), f_job->music.size(), f_job->evidence.size()};
+
+  for (int n_kind = SCAN_CHARS ; n_kind <= SCAN_EVIDENCE ; ++n_kind)
+  {
+    for (int n_begin = 0 ; n_begin < f_sizes[n_kind] ; n_begin += scan_chunk_size)
+    {
+      int f_end = qMin(n_begin + scan_chunk_size, f_sizes[n_kind]);
+      f_tasks.append(new AssetScanTask(this, f_job, static_cast<asset_scan_kind>(n_kind), n_begin, f_end));
+    }
+  }
+
+  m_job = f_job;
+  m_scan_timer.start();
+
+  if (f_tasks.isEmpty())
+  {
+    on_scan_finished();
+    return;
+  }
+
+  f_job->remaining.storeRelease(f_tasks.size());
+
+  for (AssetScanTask *i_task : f_tasks)
+    m_pool.start(i_task);
+}
+
+void AssetScanner::cancel()
+{
+  if (!m_job.isNull())
+    m_job->cancelled.storeRelease(1);
+
+  m_job.clear();
+}
+
+void AssetScanner::on_scan_finished()
+{
+  //an abandoned scan may still report in after the current one has started
+  if (m_job.isNull() || m_ready || m_job->remaining.loadAcquire() != 0)
+    return;
+
+  m_char_inis = to_bits(m_job->char_inis);
+  m_char_icons = to_bits(m_job->char_icons);
+  m_music = to_bits(m_job->music_found);
+  m_evidence = to_bits(m_job->evidence_found);
+
+  m_ready = true;
+
+  qDebug() << "asset scan: checked" << m_char_inis.size() << "characters," << m_music.size() << "songs and"
+           << m_evidence.size() << "evidence images in" << m_scan_timer.elapsed() << "ms";
+
+  report_missing();
+
+  m_job.clear();
+
+  emit finished();
+}
+
+void AssetScanner::report_missing()
+{
+  QStringList f_chars;
+  QStringList f_songs;
+  QStringList f_evidence;
+
+  for (int n_char = 0 ; n_char < m_char_inis.size() ; ++n_char)
+  {
+    if (!m_char_inis.testBit(n_char))
+      f_chars.append(m_job->chars.at(n_char));
+  }
+
+  for (int n_song = 0 ; n_song < m_music.size() ; ++n_song)
+  {
+    QString f_song = m_job->music.at(n_song);
+
+    //areas and categories share the list with the songs, they have no extension and are never files
+    if (!m_music.testBit(n_song) && f_song.contains("."))
+      f_songs.append(f_song);
+  }
+
+  for (int n_evi = 0 ; n_evi < m_evidence.size() ; ++n_evi)
+  {
+    if (!m_evidence.testBit(n_evi))
+      f_evidence.append(m_job->evidence.at(n_evi));
+  }
+
+  if (!f_chars.isEmpty())
+    qDebug() << "W: missing" << f_chars.size() << "characters:" << f_chars.join(", ");
+
+  if (!f_songs.isEmpty())
+    qDebug() << "W: missing" << f_songs.size() << "songs:" << f_songs.join(", ");
+
+  if (!f_evidence.isEmpty())
+    qDebug() << "W: missing" << f_evidence.size() << "evidence images:" << f_evidence.join(", ");
+}
@@ -0,0 +1,62 @@
+#ifndef ASSETSCANNER_H
+#define ASSETSCANNER_H
+
+#include "datatypes.h"
+
+#include <QObject>
+#include <QBitArray>
+#include <QVector>
+#include <QThreadPool>
+#include <QSharedPointer>
+#include <QElapsedTimer>
+
+class AOApplication;
+struct asset_scan_job_type;
+
+//finds out which of the server's characters, songs and evidence images exist locally, right after the lists arrive
+//the lists are split into chunks that are checked on a thread pool. until is_ready() the bitsets are empty
+//and callers have to look at the disk themselves
+class AssetScanner : public QObject
+{
+  Q_OBJECT
+
+public:
+  AssetScanner(AOApplication *p_ao_app, QObject *parent = nullptr);
+  ~AssetScanner();
+
+  //a scan that is still running is abandoned
+  void scan(const QVector<char_type> &p_chars, const QVector<QString> &p_music, const QVector<evi_type> &p_evidence);
+  void cancel();
+
+  bool is_ready() {return m_ready;}
+
+  //one bit per entry of the list that was scanned
+  const QBitArray &get_char_inis() {return m_char_inis;}
+  const QBitArray &get_char_icons() {return m_char_icons;}
+  const QBitArray &get_music() {return m_music;}
+  const QBitArray &get_evidence() {return m_evidence;}
+
+signals:
+  void finished();
+
+private:
+  AOApplication *ao_app;
+
+  QThreadPool m_pool;
+  QSharedPointer<asset_scan_job_type> m_job;
+  QElapsedTimer m_scan_timer;
+
+  bool m_ready = false;
+
+  QBitArray m_char_inis;
+  QBitArray m_char_icons;
+  QBitArray m_music;
+  QBitArray m_evidence;
+
+  void report_missing();
+
+private slots:
+  void on_scan_finished();
+};
+
+#endif // ASSETSCANNER_H
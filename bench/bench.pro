@@ -0,0 +1,13 @@
+#-------------------------------------------------
+#
+# microbenchmarks that check their result against the code they replaced before timing it
+#
+#-------------------------------------------------
+
+TEMPLATE = subdirs
+
+SUBDIRS += packet_escape \
+    fanta \
+    callwords \
+    frames \
+    scaled_load
@@ -0,0 +1,237 @@
+#include "callwordmatcher.h"
+
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QTextStream>
+
+#include <random>
+
+//get_call_words() and the loop in handle_chatmessage_3 as they were before the automaton, kept as the reference
+static QStringList legacy_get_call_words(QString p_path)
+{
+  QStringList return_value;
+
+  QFile callwords_ini;
+
+  callwords_ini.setFileName(p_path);
+
+  if (!callwords_ini.open(QIODevice::ReadOnly))
+    return return_value;
+
+  QTextStream in(&callwords_ini);
+
+  while (!in.atEnd())
+  {
+    QString line = in.readLine();
+    return_value.append(line);
+  }
+
+  return return_value;
+}
+
+static bool legacy_matches(const QStringList &p_call_words, const QString &p_message)
+{
+  for (QString word : p_call_words)
+  {
+    if (p_message.contains(word, Qt::CaseInsensitive))
+      return true;
+  }
+
+  return false;
+}
+
+class bench_CallWords : public QObject
+{
+  Q_OBJECT
+
+private:
+  static const int word_count = 1000;
+  static const int message_count = 2000;
+
+  QTemporaryDir m_dir;
+  QString m_path;
+
+  QStringList m_words;
+  QStringList m_messages;
+  //characters in m_messages, for the throughput
+  qint64 m_message_chars = 0;
+
+  int m_hits = 0;
+
+  void report_throughput(qint64 p_nsecs);
+
+private slots:
+  void initTestCase();
+
+  void matcher_agrees_with_legacy();
+
+  void legacy_with_file_read();
+  void legacy_contains_only();
+  void automaton();
+};
+
+//made up words, most of them nickname-like and a few that share prefixes and suffixes with each other,
+//written out in mixed case the way moderators tend to. messages are chat-like and one in ten has a call word in it
+void bench_CallWords::initTestCase()
+{
+  QVERIFY(m_dir.isValid());
+  m_path = m_dir.path() + "/callwords.ini";
+
+  std::mt19937 f_random(1000);
+  const QStringList f_syllables = {"ka", "ri", "mo", "phoe", "nix", "ed", "ge", "worth", "ma", "ya", "fran", "zi",
+                                   "ska", "gum", "shoe", "lar", "ry", "mod", "help", "ban", "kick", "ju", "dge", "von"};
+
+  while (m_words.size() < word_count)
+  {
+    QString f_word;
+    int f_length = 2 + f_random() % 3;
+
+    for (int n_syllable = 0 ; n_syllable < f_length ; ++n_syllable)
+      f_word += f_syllables.at(f_random() % f_syllables.size());
+
+    if (f_random() % 4 == 0)
+      f_word[0] = f_word.at(0).toUpper();
+
+    if (!m_words.contains(f_word, Qt::CaseInsensitive))
+      m_words.append(f_word);
+  }
+
+  QFile f_file(m_path);
+  QVERIFY(f_file.open(QIODevice::WriteOnly | QIODevice::Text));
+
+  QTextStream f_stream(&f_file);
+
+  for (QString i_word : m_words)
+    f_stream << i_word << "\n";
+
+  f_stream.flush();
+  f_file.close();
+
+  const QStringList f_lines = {
+    "Objection! The witness is clearly lying about the time of the murder.",
+    "hold it",
+    "I think we should take a short recess before the next testimony.",
+    "Can someone swap to the prosecution bench? I'll take defense.",
+    "~~The court will now hear the closing arguments.",
+    "lol",
+    "Where was the victim at 9:45 PM? Nobody has explained that yet.",
+    "Ünïcödé tëxt ís stïll téxt, ßo ít gëts földëd tóó."
+  };
+
+  for (int n_message = 0 ; n_message < message_count ; ++n_message)
+  {
+    QString f_message = f_lines.at(f_random() % f_lines.size());
+
+    if (n_message % 10 == 0)
+    {
+      QString f_word = m_words.at(f_random() % m_words.size());
+      f_message.insert(f_random() % (f_message.size() + 1), " " + f_word.toUpper() + " ");
+    }
+
+    m_messages.append(f_message);
+    m_message_chars += f_message.size();
+  }
+}
+
+//p_nsecs is the time one pass over every message took
+void bench_CallWords::report_throughput(qint64 p_nsecs)
+{
+  if (p_nsecs <= 0)
+    return;
+
+  qDebug() << word_count << "words:" << qRound64(message_count * 1e9 / p_nsecs) << "messages/s,"
+           << qRound64(m_message_chars * 1e9 / p_nsecs) << "chars/s";
+}
+
+void bench_CallWords::matcher_agrees_with_legacy()
+{
+  CallWordMatcher f_matcher(m_path);
+  QStringList f_words = legacy_get_call_words(m_path);
+
+  QCOMPARE(f_matcher.get_words(), f_words);
+
+  int f_hits = 0;
+
+  for (QString i_message : m_messages)
+  {
+    bool f_expected = legacy_matches(f_words, i_message);
+    QCOMPARE(f_matcher.matches(i_message), f_expected);
+
+    if (f_expected)
+      ++f_hits;
+  }
+
+  //a corpus where nothing or everything matches proves little
+  QVERIFY(f_hits >= message_count / 10);
+  QVERIFY(f_hits < message_count);
+}
+
+//what every IC message used to cost
+void bench_CallWords::legacy_with_file_read()
+{
+  QElapsedTimer f_timer;
+  f_timer.start();
+  int f_runs = 0;
+
+  QBENCHMARK
+  {
+    for (QString i_message : m_messages)
+    {
+      if (legacy_matches(legacy_get_call_words(m_path), i_message))
+        ++m_hits;
+    }
+
+    ++f_runs;
+  }
+
+  report_throughput(f_timer.nsecsElapsed() / qMax(f_runs, 1));
+}
+
+void bench_CallWords::legacy_contains_only()
+{
+  QStringList f_words = legacy_get_call_words(m_path);
+
+  QElapsedTimer f_timer;
+  f_timer.start();
+  int f_runs = 0;
+
+  QBENCHMARK
+  {
+    for (QString i_message : m_messages)
+    {
+      if (legacy_matches(f_words, i_message))
+        ++m_hits;
+    }
+
+    ++f_runs;
+  }
+
+  report_throughput(f_timer.nsecsElapsed() / qMax(f_runs, 1));
+}
+
+void bench_CallWords::automaton()
+{
+  CallWordMatcher f_matcher(m_path);
+
+  QElapsedTimer f_timer;
+  f_timer.start();
+  int f_runs = 0;
+
+  QBENCHMARK
+  {
+    for (QString i_message : m_messages)
+    {
+      if (f_matcher.matches(i_message))
+        ++m_hits;
+    }
+
+    ++f_runs;
+  }
+
+  report_throughput(f_timer.nsecsElapsed() / qMax(f_runs, 1));
+}
+
+QTEST_GUILESS_MAIN(bench_CallWords)
+
+#include "bench_callwords.moc"
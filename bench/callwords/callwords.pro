@@ -0,0 +1,21 @@
+#-------------------------------------------------
+#
+# CallWordMatcher against the contains() loop it replaced, with 1,000 call words
+#
+#-------------------------------------------------
+
+QT       += core testlib
+QT       -= gui
+
+CONFIG   += console c++11 testcase
+CONFIG   -= app_bundle
+
+TARGET = bench_callwords
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../..
+
+SOURCES += bench_callwords.cpp \
+    $$PWD/../../callwordmatcher.cpp
+
+HEADERS += $$PWD/../../callwordmatcher.h
@@ -0,0 +1,227 @@
+#include "encryption_functions.h"
+#include "hex_functions.h"
+
+#include <QtTest>
+#include <QVector>
+
+#include <cstddef>
+#include <stdlib.h>
+#include <random>
+
+//fanta_encrypt()/fanta_decrypt() as they were before the hex table, kept as the reference
+static QString legacy_fanta_encrypt(QString temp_input, unsigned int p_key)
+{
+  unsigned int key = p_key;
+  unsigned int C1 = 53761;
+  unsigned int C2 = 32618;
+
+  QVector<uint_fast8_t> temp_result;
+  std::string input = temp_input.toUtf8().constData();
+
+  for (unsigned int pos = 0 ; pos < input.size() ; ++pos)
+  {
+    uint_fast8_t output = input.at(pos) ^ (key >> 8) % 256;
+    temp_result.append(output);
+    key = (temp_result.at(pos) + key) * C1 + C2;
+  }
+
+  std::string result = "";
+
+  for (uint_fast8_t i_int : temp_result)
+  {
+    result += omni::int_to_hex(i_int);
+  }
+
+  return QString::fromStdString(result);
+}
+
+static QString legacy_fanta_decrypt(QString temp_input, unsigned int key)
+{
+  std::string input = temp_input.toUtf8().constData();
+
+  QVector<unsigned int> unhexed_vector;
+
+  for(unsigned int i=0; i< input.length(); i+=2)
+  {
+    std::string byte = input.substr(i,2);
+    unsigned int hex_int = strtoul(byte.c_str(), nullptr, 16);
+    unhexed_vector.append(hex_int);
+  }
+
+  unsigned int C1 = 53761;
+  unsigned int C2 = 32618;
+
+  std::string result = "";
+
+  for (int pos = 0 ; pos < unhexed_vector.size() ; ++pos)
+  {
+    unsigned char output = unhexed_vector.at(pos) ^ (key >> 8) % 256;
+    result += output;
+    key = (unhexed_vector.at(pos) + key) * C1 + C2;
+  }
+
+  return QString::fromStdString(result);
+}
+
+class bench_Fanta : public QObject
+{
+  Q_OBJECT
+
+private:
+  QStringList m_inputs;
+  QVector<unsigned int> m_keys;
+
+  //the headers the client actually encrypts, for the timing runs
+  QStringList m_headers;
+  //and what they look like encrypted
+  QStringList m_encrypted_headers;
+
+  int m_checksum = 0;
+
+private slots:
+  void initTestCase();
+
+  void encrypt_matches_legacy();
+  void decrypt_matches_legacy();
+  void decrypt_of_any_hex_matches_legacy();
+
+  void legacy_encrypt();
+  void table_encrypt();
+  void legacy_decrypt();
+  void table_decrypt();
+};
+
+//the legacy code read its input through a C string, so inputs never contain a NUL here;
+//for those the two disagree by design (the old one stopped at the NUL)
+void bench_Fanta::initTestCase()
+{
+  std::mt19937 f_random(20170210);
+
+  m_headers = QStringList{"HI", "ID", "askchaa", "askchar2", "RC", "RM", "RD", "CC", "MS", "CT", "MC", "HP", "RT", "PE",
+                          "DE", "EE", "ZZ", "CH"};
+
+  m_inputs = m_headers;
+  m_inputs << "" << "a" << "%" << "#" << "ÄÖÜäöüß" << "逆転裁判" << QString::fromUtf8("\xF0\x9F\x98\x80");
+
+  //random printable ASCII and random non-NUL code points, short and long
+  for (int n_input = 0 ; n_input < 500 ; ++n_input)
+  {
+    int f_size = f_random() % 80;
+    QString f_input;
+
+    for (int n_char = 0 ; n_char < f_size ; ++n_char)
+    {
+      if (n_input % 2 == 0)
+        f_input.append(QChar(static_cast<ushort>(' ' + f_random() % 95)));
+      else
+        f_input.append(QChar(static_cast<ushort>(1 + f_random() % 0xD7FF)));
+    }
+
+    m_inputs.append(f_input);
+  }
+
+  m_keys << 0 << 1 << 5 << 255 << 256 << 65535 << 65536 << 0x7FFFFFFF << 0xFFFFFFFF;
+
+  for (int n_key = 0 ; n_key < 200 ; ++n_key)
+    m_keys.append(f_random());
+
+  //5 is the key every server out there hands out
+  for (QString i_header : m_headers)
+    m_encrypted_headers.append(legacy_fanta_encrypt(i_header, 5));
+}
+
+void bench_Fanta::encrypt_matches_legacy()
+{
+  for (unsigned int i_key : m_keys)
+  {
+    for (QString i_input : m_inputs)
+    {
+      QString f_expected = legacy_fanta_encrypt(i_input, i_key);
+      QString f_result = fanta_encrypt(i_input, i_key);
+
+      QCOMPARE(f_result.toUtf8(), f_expected.toUtf8());
+    }
+  }
+}
+
+void bench_Fanta::decrypt_matches_legacy()
+{
+  for (unsigned int i_key : m_keys)
+  {
+    for (QString i_input : m_inputs)
+    {
+      QString f_encrypted = legacy_fanta_encrypt(i_input, i_key);
+
+      QString f_expected = legacy_fanta_decrypt(f_encrypted, i_key);
+      QString f_result = fanta_decrypt(f_encrypted, i_key);
+
+      QCOMPARE(f_result.toUtf8(), f_expected.toUtf8());
+      QCOMPARE(f_result, i_input);
+    }
+  }
+}
+
+//whatever a server sends: odd lengths, lowercase, and pairs that strtoul only half parses.
+//whitespace and signs are left out, strtoul skips those and the table doesn't
+void bench_Fanta::decrypt_of_any_hex_matches_legacy()
+{
+  std::mt19937 f_random(5);
+  const char f_digits[] = "0123456789ABCDEFabcdefxXgz";
+
+  for (int n_input = 0 ; n_input < 5000 ; ++n_input)
+  {
+    int f_size = f_random() % 40;
+    QString f_input;
+
+    for (int n_char = 0 ; n_char < f_size ; ++n_char)
+    {
+      //mostly real hex digits
+      int f_digit = f_random() % 64;
+      f_input.append(QLatin1Char(f_digits[f_digit < 26 ? f_digit : f_digit % 22]));
+    }
+
+    unsigned int f_key = m_keys.at(n_input % m_keys.size());
+
+    QCOMPARE(fanta_decrypt(f_input, f_key).toUtf8(), legacy_fanta_decrypt(f_input, f_key).toUtf8());
+  }
+}
+
+void bench_Fanta::legacy_encrypt()
+{
+  QBENCHMARK
+  {
+    for (QString i_header : m_headers)
+      m_checksum += legacy_fanta_encrypt(i_header, 5).size();
+  }
+}
+
+void bench_Fanta::table_encrypt()
+{
+  QBENCHMARK
+  {
+    for (QString i_header : m_headers)
+      m_checksum += fanta_encrypt(i_header, 5).size();
+  }
+}
+
+void bench_Fanta::legacy_decrypt()
+{
+  QBENCHMARK
+  {
+    for (QString i_header : m_encrypted_headers)
+      m_checksum += legacy_fanta_decrypt(i_header, 5).size();
+  }
+}
+
+void bench_Fanta::table_decrypt()
+{
+  QBENCHMARK
+  {
+    for (QString i_header : m_encrypted_headers)
+      m_checksum += fanta_decrypt(i_header, 5).size();
+  }
+}
+
+QTEST_GUILESS_MAIN(bench_Fanta)
+
+#include "bench_fanta.moc"
@@ -0,0 +1,23 @@
+#-------------------------------------------------
+#
+# fanta_encrypt()/fanta_decrypt() against the std::string and omni::int_to_hex versions they replaced
+# hex_functions only lives on here, for the reference versions. the client doesn't use it anymore
+#
+#-------------------------------------------------
+
+QT       += core testlib
+QT       -= gui
+
+CONFIG   += console c++11 testcase
+CONFIG   -= app_bundle
+
+TARGET = bench_fanta
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../..
+
+SOURCES += bench_fanta.cpp \
+    hex_functions.cpp \
+    $$PWD/../../encryption_functions.cpp
+
+HEADERS += hex_functions.h
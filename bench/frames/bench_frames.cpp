@@ -0,0 +1,182 @@
+#include "framecache.h"
+
+#include <QtTest>
+#include <QLabel>
+#include <QImageReader>
+#include <QSignalSpy>
+
+class bench_Frames : public QObject
+{
+  Q_OBJECT
+
+private:
+  //what AOCharMovie draws into, hidden so nothing is ever painted
+  QLabel m_label;
+
+  int m_checksum = 0;
+
+  //every frame as the old load() kept it, unscaled
+  static QVector<QImage> legacy_load(QString p_path);
+  //waits for p_cache to have the set, r_decode_msecs is how long decoding took
+  static QSharedPointer<const frame_set_type> wait_for_frames(FrameCache &p_cache, QString p_path, QSize p_size,
+                                                              qint64 &r_decode_msecs);
+
+  void add_rows();
+
+private slots:
+  void cached_frames_match_legacy_data();
+  void cached_frames_match_legacy();
+
+  void legacy_per_frame_data();
+  void legacy_per_frame();
+  void cached_per_frame_data();
+  void cached_per_frame();
+};
+
+QVector<QImage> bench_Frames::legacy_load(QString p_path)
+{
+  QVector<QImage> f_frames;
+  QImageReader f_reader(p_path);
+
+  QImage f_image = f_reader.read();
+  while (!f_image.isNull())
+  {
+    f_frames.append(f_image);
+    f_image = f_reader.read();
+  }
+
+  return f_frames;
+}
+
+QSharedPointer<const frame_set_type> bench_Frames::wait_for_frames(FrameCache &p_cache, QString p_path, QSize p_size,
+                                                                   qint64 &r_decode_msecs)
+{
+  QSignalSpy f_spy(&p_cache, SIGNAL(frames_ready(QString)));
+  QString f_key = FrameCache::make_key(p_path, p_size, false);
+
+  QElapsedTimer f_timer;
+  f_timer.start();
+
+  QSharedPointer<const frame_set_type> f_frame_set = p_cache.get_frames(p_path, p_size, false);
+
+  while (f_frame_set.isNull())
+  {
+    if (!f_spy.wait(10000))
+      return f_frame_set;
+
+    for (QList<QVariant> i_arguments : f_spy)
+    {
+      if (i_arguments.at(0).toString() == f_key)
+        f_frame_set = p_cache.get_frames(p_path, p_size, false);
+    }
+
+    f_spy.clear();
+  }
+
+  r_decode_msecs = f_timer.elapsed();
+
+  return f_frame_set;
+}
+
+//the default theme's viewport and the same upscaled 4x, on the theme's own animations
+void bench_Frames::add_rows()
+{
+  QTest::addColumn<QString>("path");
+  QTest::addColumn<QSize>("size");
+
+  const QStringList f_files = {"objection.gif", "holdit.gif", "defense_speedlines.gif", "testimony.gif"};
+
+  for (QString i_file : f_files)
+  {
+    QString f_path = QString(DEFAULT_THEME_PATH) + i_file;
+
+    QTest::newRow(qPrintable(i_file + " 256x192")) << f_path << QSize(256, 192);
+    QTest::newRow(qPrintable(i_file + " 1024x768")) << f_path << QSize(1024, 768);
+  }
+}
+
+void bench_Frames::cached_frames_match_legacy_data()
+{
+  add_rows();
+}
+
+//same frames, already in the size the old code scaled them to on the fly
+void bench_Frames::cached_frames_match_legacy()
+{
+  QFETCH(QString, path);
+  QFETCH(QSize, size);
+
+  QVector<QImage> f_legacy = legacy_load(path);
+  QVERIFY(!f_legacy.isEmpty());
+
+  FrameCache f_cache(256 * 1024);
+  qint64 f_decode_msecs = 0;
+  QSharedPointer<const frame_set_type> f_frame_set = wait_for_frames(f_cache, path, size, f_decode_msecs);
+
+  QVERIFY(!f_frame_set.isNull());
+  QVERIFY(f_frame_set->complete);
+  QCOMPARE(f_frame_set->frames.size(), f_legacy.size());
+
+  for (QPixmap i_frame : f_frame_set->frames)
+    QCOMPARE(i_frame.size(), size);
+
+  qDebug() << "decoded and prepared once, off the GUI thread, in" << f_decode_msecs << "ms";
+}
+
+void bench_Frames::legacy_per_frame_data()
+{
+  add_rows();
+}
+
+//AOCharMovie::frame_change() before: convert and scale the frame that comes up next
+void bench_Frames::legacy_per_frame()
+{
+  QFETCH(QString, path);
+  QFETCH(QSize, size);
+
+  QVector<QImage> f_frames = legacy_load(path);
+  QVERIFY(!f_frames.isEmpty());
+
+  m_label.resize(size);
+  int n_frame = 0;
+
+  QBENCHMARK
+  {
+    QPixmap f_pixmap = QPixmap::fromImage(f_frames.at(n_frame++ % f_frames.size()));
+
+    m_label.setPixmap(f_pixmap.scaled(m_label.width(), m_label.height()));
+    m_checksum += m_label.pixmap()->width();
+  }
+}
+
+void bench_Frames::cached_per_frame_data()
+{
+  add_rows();
+}
+
+//and now: the frame is a pixmap of the right size already
+void bench_Frames::cached_per_frame()
+{
+  QFETCH(QString, path);
+  QFETCH(QSize, size);
+
+  FrameCache f_cache(256 * 1024);
+  qint64 f_decode_msecs = 0;
+  QSharedPointer<const frame_set_type> f_frame_set = wait_for_frames(f_cache, path, size, f_decode_msecs);
+
+  QVERIFY(!f_frame_set.isNull());
+  QVERIFY(!f_frame_set->frames.isEmpty());
+
+  m_label.resize(size);
+  int n_frame = 0;
+
+  QBENCHMARK
+  {
+    m_label.setPixmap(f_frame_set->frames.at(n_frame++ % f_frame_set->frames.size()));
+    m_checksum += m_label.pixmap()->width();
+  }
+}
+
+QTEST_MAIN(bench_Frames)
+
+#include "bench_frames.moc"
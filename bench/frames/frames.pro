@@ -0,0 +1,25 @@
+#-------------------------------------------------
+#
+# per frame cost of showing an animation: converting and scaling every frame as it comes up against
+# handing out the pixmaps FrameCache prepared once, at the default theme's viewport and 4x that
+# needs a display, run with QT_QPA_PLATFORM=offscreen where there is none
+#
+#-------------------------------------------------
+
+QT       += core gui widgets testlib
+
+CONFIG   += console c++11 testcase
+CONFIG   -= app_bundle
+
+TARGET = bench_frames
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../..
+
+DEFINES += DEFAULT_THEME_PATH=\\\"$$PWD/../../base/themes/default/\\\"
+
+SOURCES += bench_frames.cpp \
+    $$PWD/../../framecache.cpp \
+    $$PWD/../../image_functions.cpp
+
+HEADERS += $$PWD/../../framecache.h
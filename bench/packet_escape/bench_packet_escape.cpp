@@ -0,0 +1,284 @@
+#include "aopacket.h"
+
+#include <QtTest>
+#include <QFile>
+#include <QTextStream>
+
+//net_encode()/net_decode() as they were before the single pass escaper, kept as the reference
+static void legacy_net_encode(QStringList &p_contents)
+{
+  for (int n_element = 0 ; n_element < p_contents.size() ; ++n_element)
+  {
+    QString f_element = p_contents.at(n_element);
+    f_element.replace("#", "<num>").replace("%", "<percent>").replace("$", "<dollar>").replace("&", "<and>");
+
+    p_contents.removeAt(n_element);
+    p_contents.insert(n_element, f_element);
+  }
+}
+
+static void legacy_net_decode(QStringList &p_contents)
+{
+  for (int n_element = 0 ; n_element < p_contents.size() ; ++n_element)
+  {
+    QString f_element = p_contents.at(n_element);
+    f_element.replace("<num>", "#").replace("<percent>", "%").replace("<dollar>", "$").replace("<and>", "&");
+
+    p_contents.removeAt(n_element);
+    p_contents.insert(n_element, f_element);
+  }
+}
+
+//the old AOPacket constructor: everything between the header and the last # is a field
+static QStringList legacy_split(QString p_packet, QString &r_header)
+{
+  QStringList f_split = p_packet.split("#");
+  r_header = f_split.at(0);
+
+  return f_split.mid(1, f_split.size() - 2);
+}
+
+class bench_PacketEscape : public QObject
+{
+  Q_OBJECT
+
+private:
+  //packets the way they are on the wire, without the terminating %
+  QStringList m_wire;
+
+  //the same packets split and unescaped by the legacy code, ready to be encoded again
+  QStringList m_headers;
+  QVector<QStringList> m_contents;
+
+  //keeps the compiler from dropping the work being timed
+  int m_checksum = 0;
+
+  static QStringList sample_traffic();
+  static QStringList read_traffic_log(QString p_path);
+
+private slots:
+  void initTestCase();
+
+  void encode_matches_legacy();
+  void decode_matches_legacy();
+
+  void legacy_encode();
+  void single_pass_encode();
+  void legacy_decode();
+  void single_pass_decode();
+};
+
+//synthesized, not recorded: MS/SM traffic shaped like a busy courtroom, where most fields have nothing to escape
+//and chat now and then has a #, %, $ or &
+QStringList bench_PacketEscape::sample_traffic()
+{
+  const QStringList f_chars = {"Phoenix", "Edgeworth", "Maya", "Franziska", "Gumshoe", "Judge"};
+  const QStringList f_emotes = {"normal", "thinking", "pointing", "sweating", "confident", "deskslam"};
+  const QStringList f_messages = {
+    "Objection!",
+    "The defense is ready, Your Honor.",
+    "Hold it! That contradicts the autopsy report.",
+    "I'm 100<percent> sure the witness is lying.",
+    "Exhibit <num>3 doesn't match the crime scene photo.",
+    "He only paid <dollar>20 for the bust, not <dollar>2000.",
+    "Q<and>A after the recess, please.",
+    "...",
+    "Take that!",
+    "The victim was last seen at 9:45 PM near the Gatewater Hotel lobby.",
+    "~~Order in the court!",
+    "This is a long testimony line that goes on for a while, because witnesses never get to the point "
+    "and the client has to carry every character of it through the escaper in both directions."
+  };
+
+  QStringList f_traffic;
+
+  for (int n_packet = 0 ; n_packet < 2000 ; ++n_packet)
+  {
+    QString f_char = f_chars.at(n_packet % f_chars.size());
+    QString f_emote = f_emotes.at((n_packet / 3) % f_emotes.size());
+    QString f_message = f_messages.at((n_packet * 7) % f_messages.size());
+
+    QStringList f_fields = {"chat", "-", f_char, f_emote, f_message, "def", "1", "0",
+                            QString::number(n_packet % 60), "0", "0", "0", "0", "0", QString::number(n_packet % 7)};
+
+    f_traffic.append("MS#" + f_fields.join("#") + "#");
+
+    if (n_packet % 50 == 0)
+      f_traffic.append("CT#" + f_char + "#" + f_message + "#");
+
+    if (n_packet % 200 == 0)
+      f_traffic.append("MC#Trial<and>Tribulations.mp3#" + QString::number(n_packet % 60) + "#");
+  }
+
+  //the music list a server sends once on join
+  QStringList f_music = {"SM", "Lobby", "Courtroom 1", "Courtroom 2", "Detention Center"};
+
+  for (int n_track = 0 ; n_track < 300 ; ++n_track)
+    f_music.append(QString("Track %1 - Cornered <num>%2 (100<percent>).mp3").arg(n_track).arg(n_track % 5));
+
+  f_traffic.append(f_music.join("#") + "#");
+
+  return f_traffic;
+}
+
+//takes the R: and S: lines of a client debug log, which qDebug() quotes
+QStringList bench_PacketEscape::read_traffic_log(QString p_path)
+{
+  QStringList f_traffic;
+
+  QFile f_file(p_path);
+
+  if (!f_file.open(QIODevice::ReadOnly | QIODevice::Text))
+  {
+    qWarning() << "W: could not open" << p_path;
+    return f_traffic;
+  }
+
+  QTextStream f_stream(&f_file);
+  f_stream.setCodec("UTF-8");
+
+  const QStringList f_prefixes = {"R: \"", "S: \"", "R(ms): \"", "S(ms): \""};
+
+  while (!f_stream.atEnd())
+  {
+    QString f_line = f_stream.readLine();
+
+    for (QString i_prefix : f_prefixes)
+    {
+      int f_start = f_line.indexOf(i_prefix);
+      int f_end = f_line.lastIndexOf('"');
+
+      if (f_start < 0 || f_end <= f_start + i_prefix.size())
+        continue;
+
+      QString f_packet = f_line.mid(f_start + i_prefix.size(), f_end - f_start - i_prefix.size());
+      f_packet.replace("\\\"", "\"").replace("\\\\", "\\");
+
+      if (f_packet.endsWith("%"))
+        f_packet.chop(1);
+
+      if (f_packet.contains('#'))
+        f_traffic.append(f_packet);
+
+      break;
+    }
+  }
+
+  return f_traffic;
+}
+
+void bench_PacketEscape::initTestCase()
+{
+  QString f_log = QString::fromLocal8Bit(qgetenv("AO_TRAFFIC_LOG"));
+
+  if (f_log.isEmpty())
+    m_wire = sample_traffic();
+  else
+    m_wire = read_traffic_log(f_log);
+
+  QVERIFY2(!m_wire.isEmpty(), "no packets to run on");
+  qDebug() << m_wire.size() << "packets from" << (f_log.isEmpty() ? QString("the built in sample") : f_log);
+
+  for (QString i_packet : m_wire)
+  {
+    QString f_header;
+    QStringList f_contents = legacy_split(i_packet, f_header);
+    legacy_net_decode(f_contents);
+
+    m_headers.append(f_header);
+    m_contents.append(f_contents);
+  }
+}
+
+void bench_PacketEscape::encode_matches_legacy()
+{
+  for (int n_packet = 0 ; n_packet < m_contents.size() ; ++n_packet)
+  {
+    QStringList f_expected = m_contents.at(n_packet);
+    legacy_net_encode(f_expected);
+
+    QStringList f_contents = m_contents.at(n_packet);
+    AOPacket f_packet(m_headers.at(n_packet), f_contents);
+    f_packet.net_encode();
+
+    QCOMPARE(f_packet.get_contents(), f_expected);
+  }
+}
+
+//the legacy code decodes a token that only appears once another one has been replaced ("<<and>num>" becomes "<num>"),
+//the single pass doesn't. nothing the client or server sends looks like that
+void bench_PacketEscape::decode_matches_legacy()
+{
+  for (int n_packet = 0 ; n_packet < m_wire.size() ; ++n_packet)
+  {
+    AOPacket f_packet(m_wire.at(n_packet));
+    f_packet.net_decode();
+
+    QCOMPARE(f_packet.get_header(), m_headers.at(n_packet));
+    QCOMPARE(f_packet.get_field_count(), m_contents.at(n_packet).size());
+
+    //field by field first, that is the lazy path the packet handlers take
+    for (int n_field = 0 ; n_field < f_packet.get_field_count() ; ++n_field)
+      QCOMPARE(f_packet.get_field(n_field), m_contents.at(n_packet).at(n_field));
+
+    QCOMPARE(f_packet.get_contents(), m_contents.at(n_packet));
+  }
+}
+
+void bench_PacketEscape::legacy_encode()
+{
+  QBENCHMARK
+  {
+    for (QStringList i_contents : m_contents)
+    {
+      legacy_net_encode(i_contents);
+      m_checksum += i_contents.size();
+    }
+  }
+}
+
+void bench_PacketEscape::single_pass_encode()
+{
+  QBENCHMARK
+  {
+    for (int n_packet = 0 ; n_packet < m_contents.size() ; ++n_packet)
+    {
+      QStringList f_contents = m_contents.at(n_packet);
+      AOPacket f_packet(m_headers.at(n_packet), f_contents);
+      f_packet.net_encode();
+      m_checksum += f_packet.get_contents().size();
+    }
+  }
+}
+
+//both decode every field, which is the worst case for the lazy decoder
+void bench_PacketEscape::legacy_decode()
+{
+  QBENCHMARK
+  {
+    for (QString i_packet : m_wire)
+    {
+      QString f_header;
+      QStringList f_contents = legacy_split(i_packet, f_header);
+      legacy_net_decode(f_contents);
+      m_checksum += f_contents.size();
+    }
+  }
+}
+
+void bench_PacketEscape::single_pass_decode()
+{
+  QBENCHMARK
+  {
+    for (QString i_packet : m_wire)
+    {
+      AOPacket f_packet(i_packet);
+      f_packet.net_decode();
+      m_checksum += f_packet.get_contents().size();
+    }
+  }
+}
+
+QTEST_GUILESS_MAIN(bench_PacketEscape)
+
+#include "bench_packet_escape.moc"
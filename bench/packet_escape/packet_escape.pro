@@ -0,0 +1,21 @@
+#-------------------------------------------------
+#
+# AOPacket::net_encode()/net_decode() against the four chained replace() calls they replaced
+# set AO_TRAFFIC_LOG to a client debug log to run it on recorded traffic instead of the built in sample
+#
+#-------------------------------------------------
+
+QT       += core testlib
+QT       -= gui
+
+CONFIG   += console c++11 testcase
+CONFIG   -= app_bundle
+
+TARGET = bench_packet_escape
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../..
+
+SOURCES += bench_packet_escape.cpp \
+    $$PWD/../../aopacket.cpp \
+    $$PWD/../../encryption_functions.cpp
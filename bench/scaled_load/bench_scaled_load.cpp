@@ -0,0 +1,167 @@
+#include "image_functions.h"
+
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QPainter>
+#include <QPixmap>
+
+#include <random>
+
+class bench_ScaledLoad : public QObject
+{
+  Q_OBJECT
+
+private:
+  //sprites and backgrounds authored well above the viewport
+  static const int source_width = 2048;
+  static const int source_height = 1536;
+
+  QTemporaryDir m_dir;
+  QStringList m_paths;
+
+  int m_checksum = 0;
+
+  void add_rows(bool p_with_quality);
+
+private slots:
+  void initTestCase();
+
+  void scaled_load_matches_legacy_data();
+  void scaled_load_matches_legacy();
+
+  void legacy_load_data();
+  void legacy_load();
+  void scaled_load_data();
+  void scaled_load();
+};
+
+//a gradient with noise and some shapes on it, so neither format gets to compress it down to nothing
+void bench_ScaledLoad::initTestCase()
+{
+  QVERIFY(m_dir.isValid());
+
+  QImage f_image(source_width, source_height, QImage::Format_ARGB32);
+  std::mt19937 f_random(25);
+
+  for (int n_y = 0 ; n_y < source_height ; ++n_y)
+  {
+    QRgb *f_line = reinterpret_cast<QRgb*>(f_image.scanLine(n_y));
+
+    for (int n_x = 0 ; n_x < source_width ; ++n_x)
+    {
+      int f_noise = f_random() % 32;
+      f_line[n_x] = qRgba((n_x * 255 / source_width + f_noise) % 256, (n_y * 255 / source_height + f_noise) % 256,
+                          (n_x + n_y) % 256, 255);
+    }
+  }
+
+  QPainter f_painter(&f_image);
+  f_painter.setBrush(Qt::darkBlue);
+
+  for (int n_shape = 0 ; n_shape < 40 ; ++n_shape)
+    f_painter.drawEllipse(f_random() % source_width, f_random() % source_height, 50 + f_random() % 400, 50 + f_random() % 400);
+
+  f_painter.end();
+
+  m_paths.append(m_dir.path() + "/sprite.png");
+  m_paths.append(m_dir.path() + "/background.jpg");
+
+  QVERIFY(f_image.save(m_paths.at(0), "png"));
+  QVERIFY(f_image.convertToFormat(QImage::Format_RGB32).save(m_paths.at(1), "jpeg", 90));
+}
+
+//the default theme's viewport and 4x that, and with p_with_quality both quality profiles
+void bench_ScaledLoad::add_rows(bool p_with_quality)
+{
+  QTest::addColumn<QString>("path");
+  QTest::addColumn<QSize>("size");
+  QTest::addColumn<bool>("smooth");
+
+  const QVector<QSize> f_sizes = {QSize(256, 192), QSize(1024, 768)};
+
+  for (QString i_path : m_paths)
+  {
+    QString f_name = QFileInfo(i_path).fileName();
+
+    for (QSize i_size : f_sizes)
+    {
+      QString f_row = f_name + " " + QString::number(i_size.width()) + "x" + QString::number(i_size.height());
+
+      QTest::newRow(qPrintable(f_row + (p_with_quality ? " fast" : ""))) << i_path << i_size << false;
+
+      if (p_with_quality)
+        QTest::newRow(qPrintable(f_row + " smooth")) << i_path << i_size << true;
+    }
+  }
+}
+
+void bench_ScaledLoad::scaled_load_matches_legacy_data()
+{
+  add_rows(true);
+}
+
+//the image comes out at the size it's drawn at either way, only the pixels the decoder had to produce differ
+void bench_ScaledLoad::scaled_load_matches_legacy()
+{
+  QFETCH(QString, path);
+  QFETCH(QSize, size);
+  QFETCH(bool, smooth);
+
+  QImage f_full(path);
+  QVERIFY(!f_full.isNull());
+
+  QImageReader f_reader(path);
+  set_target_size(f_reader, size);
+  QImage f_decoded = f_reader.read();
+
+  QImage f_scaled = scale_image(f_decoded, size, smooth);
+  QCOMPARE(f_scaled.size(), size);
+  QCOMPARE(read_scaled_image(path, size, smooth).size(), size);
+
+  //a decoder that can't scale leaves the same image to scale_image(), so the fast profile is what the client always drew
+  if (!smooth && f_decoded.size() == f_full.size())
+    QCOMPARE(f_scaled, f_full.scaled(size, Qt::IgnoreAspectRatio, Qt::FastTransformation));
+
+  qDebug() << "decoded bytes per frame:" << f_full.byteCount() << "before," << f_decoded.byteCount() << "now,"
+           << f_scaled.byteCount() << "kept";
+}
+
+void bench_ScaledLoad::legacy_load_data()
+{
+  add_rows(false);
+}
+
+//AOImage::set_image() and AOScene::set_image() before: decode the whole file, then scale
+void bench_ScaledLoad::legacy_load()
+{
+  QFETCH(QString, path);
+  QFETCH(QSize, size);
+
+  QBENCHMARK
+  {
+    QPixmap f_pixmap(path);
+    m_checksum += f_pixmap.scaled(size.width(), size.height()).width();
+  }
+}
+
+void bench_ScaledLoad::scaled_load_data()
+{
+  add_rows(true);
+}
+
+void bench_ScaledLoad::scaled_load()
+{
+  QFETCH(QString, path);
+  QFETCH(QSize, size);
+  QFETCH(bool, smooth);
+
+  QBENCHMARK
+  {
+    QPixmap f_pixmap = QPixmap::fromImage(read_scaled_image(path, size, smooth));
+    m_checksum += f_pixmap.width();
+  }
+}
+
+QTEST_MAIN(bench_ScaledLoad)
+
+#include "bench_scaled_load.moc"
@@ -0,0 +1,19 @@
+#-------------------------------------------------
+#
+# loading a large image at the size it's drawn at against loading it whole and scaling it down afterwards
+# needs a display, run with QT_QPA_PLATFORM=offscreen where there is none
+#
+#-------------------------------------------------
+
+QT       += core gui testlib
+
+CONFIG   += console c++11 testcase
+CONFIG   -= app_bundle
+
+TARGET = bench_scaled_load
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../..
+
+SOURCES += bench_scaled_load.cpp \
+    $$PWD/../../image_functions.cpp
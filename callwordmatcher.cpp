@@ -0,0 +1,205 @@
+#include "callwordmatcher.h"
+
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QQueue>
+#include <QPair>
+
+static quint64 transition_key(int p_state, ushort p_char)
+{
+  return (static_cast<quint64>(p_state) << 16) | p_char;
+}
+
+//folds the same way QString::contains(..., Qt::CaseInsensitive) does, one UTF-16 unit at a time
+static ushort fold(QChar p_char)
+{
+  return p_char.toCaseFolded().unicode();
+}
+
+CallWordMatcher::CallWordMatcher(QString p_path, QObject *parent) : QObject(parent)
+{
+  m_path = p_path;
+
+  m_watcher = new QFileSystemWatcher(this);
+
+  connect(m_watcher, SIGNAL(fileChanged(QString)), this, SLOT(on_file_changed()));
+  connect(m_watcher, SIGNAL(directoryChanged(QString)), this, SLOT(on_file_changed()));
+
+  reload();
+  watch();
+}
+
+bool CallWordMatcher::matches(const QString &p_message)
+{
+  const QChar *f_data = p_message.constData();
+  int f_size = p_message.size();
+  int f_state = 0;
+
+  for (int n_char = 0 ; n_char < f_size ; ++n_char)
+  {
+    ushort f_char = fold(f_data[n_char]);
+
+    while (true)
+    {
+      int f_next = get_transition(f_state, f_char);
+
+      if (f_next >= 0)
+      {
+        f_state = f_next;
+        break;
+      }
+
+      if (f_state == 0)
+        break;
+
+      f_state = m_fail.at(f_state);
+    }
+
+    if (m_terminal.at(f_state))
+      return true;
+  }
+
+  return false;
+}
+
+int CallWordMatcher::get_transition(int p_state, ushort p_char)
+{
+  QHash<quint64, int>::const_iterator f_next = m_goto.constFind(transition_key(p_state, p_char));
+
+  if (f_next == m_goto.constEnd())
+    return -1;
+
+  return f_next.value();
+}
+
+void CallWordMatcher::reload()
+{
+  m_words.clear();
+
+  QFile callwords_ini(m_path);
+
+  if (callwords_ini.open(QIODevice::ReadOnly))
+  {
+    QTextStream in(&callwords_ini);
+
+    while (!in.atEnd())
+    {
+      QString f_word = in.readLine();
+
+      //an empty line used to match every single message
+      if (f_word != "")
+        m_words.append(f_word);
+    }
+  }
+
+  compile();
+}
+
+void CallWordMatcher::compile()
+{
+  m_goto.clear();
+  m_fail.clear();
+  m_terminal.clear();
+
+  m_fail.append(0);
+  m_terminal.append(false);
+
+  //only needed to walk the trie breadth first below
+  QVector<QVector<QPair<ushort, int>>> f_children(1);
+
+  for (QString i_word : m_words)
+  {
+    int f_state = 0;
+
+    for (QChar i_char : i_word)
+    {
+      ushort f_char = fold(i_char);
+      int f_next = get_transition(f_state, f_char);
+
+      if (f_next < 0)
+      {
+        f_next = m_fail.size();
+
+        m_fail.append(0);
+        m_terminal.append(false);
+        f_children.append(QVector<QPair<ushort, int>>());
+
+        m_goto.insert(transition_key(f_state, f_char), f_next);
+        f_children[f_state].append(qMakePair(f_char, f_next));
+      }
+
+      f_state = f_next;
+    }
+
+    m_terminal[f_state] = true;
+  }
+
+  //a state fails over to the longest proper suffix of its path that is also in the trie
+  //states are visited in order of depth, so that suffix has been dealt with already
+  QQueue<int> f_queue;
+  f_queue.enqueue(0);
+
+  while (!f_queue.isEmpty())
+  {
+    int f_state = f_queue.dequeue();
+
+    for (QPair<ushort, int> i_child : f_children.at(f_state))
+    {
+      int f_fail = 0;
+
+      if (f_state != 0)
+      {
+        int f_candidate = m_fail.at(f_state);
+
+        while (true)
+        {
+          int f_next = get_transition(f_candidate, i_child.first);
+
+          if (f_next >= 0)
+          {
+            f_fail = f_next;
+            break;
+          }
+
+          if (f_candidate == 0)
+            break;
+
+          f_candidate = m_fail.at(f_candidate);
+        }
+      }
+
+      m_fail[i_child.second] = f_fail;
+
+      if (m_terminal.at(f_fail))
+        m_terminal[i_child.second] = true;
+
+      f_queue.enqueue(i_child.second);
+    }
+  }
+}
+
+//the file itself is watched while it exists, otherwise the folder it's supposed to be in
+void CallWordMatcher::watch()
+{
+  QFileInfo f_info(m_path);
+
+  if (f_info.exists())
+  {
+    if (!m_watcher->files().contains(m_path))
+      m_watcher->addPath(m_path);
+  }
+  else if (f_info.dir().exists())
+  {
+    if (!m_watcher->directories().contains(f_info.path()))
+      m_watcher->addPath(f_info.path());
+  }
+}
+
+void CallWordMatcher::on_file_changed()
+{
+  watch();
+
+  reload();
+}
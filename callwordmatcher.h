@@ -0,0 +1,45 @@
+#ifndef CALLWORDMATCHER_H
+#define CALLWORDMATCHER_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QStringList>
+#include <QFileSystemWatcher>
+
+//the words of callwords.ini compiled into one Aho-Corasick automaton over case folded text,
+//so a message is checked against all of them in a single pass. recompiled whenever the file changes
+class CallWordMatcher : public QObject
+{
+  Q_OBJECT
+
+public:
+  CallWordMatcher(QString p_path, QObject *parent = nullptr);
+
+  QStringList get_words() {return m_words;}
+
+  //true if any of the words is in p_message, ignoring case
+  bool matches(const QString &p_message);
+
+private:
+  QString m_path;
+  QStringList m_words;
+  QFileSystemWatcher *m_watcher;
+
+  //state 0 is the root. m_goto maps (state, folded character) to the next state
+  QHash<quint64, int> m_goto;
+  QVector<int> m_fail;
+  //a word ends in this state or in one of the states its failure links lead to
+  QVector<bool> m_terminal;
+
+  void reload();
+  void compile();
+  void watch();
+
+  int get_transition(int p_state, ushort p_char);
+
+private slots:
+  void on_file_changed();
+};
+
+#endif // CALLWORDMATCHER_H
@@ -0,0 +1,348 @@
+#include "charprofilecache.h"
+
+#include "file_functions.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QDebug>
+
+struct char_prefetch_job_type
+{
+  QString character_path;
+  QStringList chars;
+
+  //index of the next entry of chars to load
+  QAtomicInt next;
+  //tasks still working on this job
+  QAtomicInt running;
+  QAtomicInt cancelled;
+};
+
+class CharPrefetchTask : public QRunnable
+{
+public:
+  CharPrefetchTask(CharProfileCache *p_cache, QSharedPointer<char_prefetch_job_type> p_job)
+  {
+    m_cache = p_cache;
+    m_job = p_job;
+  }
+
+  void run()
+  {
+    while (!m_job->cancelled.loadAcquire())
+    {
+      int f_entry = m_job->next.fetchAndAddOrdered(1);
+
+      if (f_entry >= m_job->chars.size())
+        break;
+
+      QString f_path = resolve_path(m_job->character_path + m_job->chars.at(f_entry) + "/char.ini");
+
+      bool f_parsed = m_cache->load_profile(f_path, nullptr);
+
+      //the counters belong to whatever prefetch is current by now
+      if (m_job->cancelled.loadAcquire())
+        break;
+
+      if (f_parsed)
+        m_cache->m_prefetch_parsed.fetchAndAddRelaxed(1);
+
+      m_cache->m_prefetch_done.fetchAndAddRelaxed(1);
+    }
+
+    //the cache waits for its pool before it goes away, so it is still there
+    if (m_job->running.fetchAndAddOrdered(-1) == 1 && !m_job->cancelled.loadAcquire())
+      QMetaObject::invokeMethod(m_cache, "on_prefetch_finished", Qt::QueuedConnection);
+  }
+
+private:
+  CharProfileCache *m_cache;
+  QSharedPointer<char_prefetch_job_type> m_job;
+};
+
+//the cache drops entries from whatever thread happens to hold the lock
+char_profile_entry_type::~char_profile_entry_type()
+{
+  if (!is_packed_path(path))
+    QMetaObject::invokeMethod(cache, "unwatch", Qt::QueuedConnection, Q_ARG(QString, path));
+}
+
+CharProfileCache::CharProfileCache(QObject *parent) : QObject(parent)
+{
+  m_profiles.setMaxCost(default_max_profiles);
+  m_prefetch_pool.setMaxThreadCount(2);
+
+  m_watcher = new QFileSystemWatcher(this);
+
+  connect(m_watcher, SIGNAL(fileChanged(QString)), this, SLOT(on_file_changed(QString)));
+}
+
+CharProfileCache::~CharProfileCache()
+{
+  cancel_prefetch();
+  m_prefetch_pool.waitForDone();
+}
+
+char_profile_type CharProfileCache::get_profile(QString p_path)
+{
+  char_profile_type f_result;
+
+  load_profile(p_path, &f_result);
+
+  return f_result;
+}
+
+bool CharProfileCache::load_profile(QString p_path, char_profile_type *r_profile)
+{
+  int f_generation;
+
+  {
+    QMutexLocker locker(&m_mutex);
+
+    char_profile_entry_type *f_cached = m_profiles.object(p_path);
+
+    if (f_cached != nullptr)
+    {
+      if (r_profile != nullptr)
+        *r_profile = f_cached->profile;
+
+      return false;
+    }
+
+    f_generation = m_generation;
+  }
+
+  //parsed without the lock, so the prefetch threads don't wait on each other
+  char_profile_type f_profile;
+  bool f_exists = parse_char_ini(p_path, &f_profile);
+
+  if (r_profile != nullptr)
+    *r_profile = f_profile;
+
+  //nothing to keep, the next load looks for the file again
+  if (!f_exists)
+    return true;
+
+  QMutexLocker locker(&m_mutex);
+
+  //somebody else was faster, or the file changed while we were reading it
+  if (m_generation != f_generation || m_profiles.contains(p_path))
+    return true;
+
+  char_profile_entry_type *f_entry = new char_profile_entry_type;
+  f_entry->cache = this;
+  f_entry->path = p_path;
+  f_entry->profile = f_profile;
+
+  m_profiles.insert(p_path, f_entry);
+  locker.unlock();
+
+  watch(p_path);
+
+  return true;
+}
+
+void CharProfileCache::watch(QString p_path)
+{
+  //packed ones never change, there is nothing to watch
+  if (is_packed_path(p_path))
+    return;
+
+  if (QThread::currentThread() != thread())
+  {
+    QMetaObject::invokeMethod(this, "watch", Qt::QueuedConnection, Q_ARG(QString, p_path));
+    return;
+  }
+
+  //watch() and unwatch() arrive in whatever order, so both go by what is cached by the time they run
+  QMutexLocker locker(&m_mutex);
+
+  if (m_profiles.contains(p_path))
+    m_watcher->addPath(p_path);
+}
+
+void CharProfileCache::unwatch(QString p_path)
+{
+  QMutexLocker locker(&m_mutex);
+
+  if (!m_profiles.contains(p_path))
+    m_watcher->removePath(p_path);
+}
+
+void CharProfileCache::clear()
+{
+  QMutexLocker locker(&m_mutex);
+
+  m_profiles.clear();
+  ++m_generation;
+}
+
+void CharProfileCache::prefetch(QString p_character_path, QStringList p_chars)
+{
+  cancel_prefetch();
+
+  {
+    QMutexLocker locker(&m_mutex);
+
+    //anything past that would only push out the ones loaded before it
+    if (p_chars.size() > m_profiles.maxCost())
+      p_chars = p_chars.mid(0, m_profiles.maxCost());
+  }
+
+  QSharedPointer<char_prefetch_job_type> f_job(new char_prefetch_job_type);
+  f_job->character_path = p_character_path;
+  f_job->chars = p_chars;
+
+  m_prefetch_total.storeRelease(p_chars.size());
+  m_prefetch_done.storeRelease(0);
+  m_prefetch_parsed.storeRelease(0);
+  m_prefetch_timer.start();
+
+  m_prefetch_job = f_job;
+
+  if (p_chars.isEmpty())
+    return;
+
+  //every task works through the shared list until it's empty, so the list order is kept
+  int f_tasks = qMin(m_prefetch_pool.maxThreadCount(), p_chars.size());
+  f_job->running.storeRelease(f_tasks);
+
+  for (int n_task = 0 ; n_task < f_tasks ; ++n_task)
+    m_prefetch_pool.start(new CharPrefetchTask(this, f_job));
+}
+
+void CharProfileCache::cancel_prefetch()
+{
+  if (!m_prefetch_job.isNull())
+    m_prefetch_job->cancelled.storeRelease(1);
+
+  m_prefetch_job.clear();
+}
+
+void CharProfileCache::set_prefetch_threads(int p_threads)
+{
+  m_prefetch_pool.setMaxThreadCount(qMax(1, p_threads));
+}
+
+void CharProfileCache::set_max_profiles(int p_max_profiles)
+{
+  QMutexLocker locker(&m_mutex);
+
+  m_profiles.setMaxCost(qMax(1, p_max_profiles));
+}
+
+void CharProfileCache::on_prefetch_finished()
+{
+  qDebug() << "char prefetch: loaded" << m_prefetch_done.loadAcquire() << "of" << m_prefetch_total.loadAcquire()
+           << "profiles (" << m_prefetch_parsed.loadAcquire() << "parsed) in" << m_prefetch_timer.elapsed() << "ms";
+}
+
+bool CharProfileCache::parse_char_ini(QString p_path, char_profile_type *r_profile)
+{
+  QFile char_ini(p_path);
+
+  if (!char_ini.open(QIODevice::ReadOnly))
+    return false;
+
+  QTextStream in(&char_ini);
+
+  //lines before the first known section are ignored, same as lines in sections we don't know
+  QHash<QString, QString> *f_section = nullptr;
+
+  while (!in.atEnd())
+  {
+    QString line = in.readLine().trimmed();
+
+    if (line.startsWith("["))
+    {
+      QString f_tag = line.left(line.indexOf("]") + 1).toLower();
+
+      if (f_tag == "[options]")
+        f_section = &r_profile->options;
+      else if (f_tag == "[time]")
+        f_section = &r_profile->time;
+      else if (f_tag == "[emotions]")
+        f_section = &r_profile->emotions;
+      else if (f_tag == "[soundn]")
+        f_section = &r_profile->sound_n;
+      else if (f_tag == "[soundt]")
+        f_section = &r_profile->sound_t;
+      else if (f_tag == "[textdelay]")
+        f_section = &r_profile->text_delay;
+      else
+        f_section = nullptr;
+
+      continue;
+    }
+
+    if (f_section == nullptr)
+      continue;
+
+    QStringList line_elements = line.split("=");
+
+    if (line_elements.size() < 2)
+      continue;
+
+    QString f_key = line_elements.at(0).trimmed().toLower();
+
+    if (!f_section->contains(f_key))
+      f_section->insert(f_key, line_elements.at(1).trimmed());
+  }
+
+  char_ini.close();
+
+  build_emote_list(p_path, r_profile);
+
+  return true;
+}
+
+void CharProfileCache::build_emote_list(QString p_path, char_profile_type *r_profile)
+{
+  int f_emote_count = r_profile->emotions.value("number").toInt();
+
+  r_profile->emote_list.reserve(f_emote_count);
+
+  for (int n_emote = 0 ; n_emote < f_emote_count ; ++n_emote)
+  {
+    QString f_key = QString::number(n_emote + 1);
+    QStringList f_parts = r_profile->emotions.value(f_key).split("#");
+
+    emote_type f_emote;
+
+    if (f_parts.size() < 4)
+      qDebug() << "W: misformatted char.ini: " << p_path << ", " << n_emote;
+    else
+    {
+      f_emote.comment = f_parts.at(0);
+      f_emote.preanim = f_parts.at(1);
+      f_emote.anim = f_parts.at(2);
+      f_emote.mod = f_parts.at(3).toInt();
+
+      if (f_parts.size() >= 5 && f_parts.at(4) != "")
+        f_emote.desk_mod = f_parts.at(4).toInt();
+    }
+
+    QString f_sfx_name = r_profile->sound_n.value(f_key);
+    if (f_sfx_name != "")
+      f_emote.sfx_name = f_sfx_name;
+
+    QString f_sfx_delay = r_profile->sound_t.value(f_key);
+    if (f_sfx_delay != "")
+      f_emote.sfx_delay = f_sfx_delay.toInt();
+
+    r_profile->emote_list.append(f_emote);
+  }
+}
+
+void CharProfileCache::on_file_changed(QString p_path)
+{
+  QMutexLocker locker(&m_mutex);
+
+  //dropping the entry unwatches the file. editors that save by replacing the file make the watcher forget it
+  //anyway, the next load watches it again
+  m_profiles.remove(p_path);
+  ++m_generation;
+}
@@ -0,0 +1,100 @@
+#ifndef CHARPROFILECACHE_H
+#define CHARPROFILECACHE_H
+
+#include "datatypes.h"
+
+#include <QObject>
+#include <QCache>
+#include <QMutex>
+#include <QFileSystemWatcher>
+#include <QThreadPool>
+#include <QSharedPointer>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+#include <QStringList>
+
+struct char_prefetch_job_type;
+class CharProfileCache;
+
+//what the cache holds. its char.ini is watched for exactly as long as it's cached, so there are never
+//more watches than profiles
+struct char_profile_entry_type
+{
+  ~char_profile_entry_type();
+
+  CharProfileCache *cache;
+  QString path;
+  char_profile_type profile;
+};
+
+//parses every char.ini once and keeps the most recently used ones around
+//a profile is dropped as soon as its char.ini changes on disk, the file stops being watched once its profile is dropped
+//profiles can be loaded ahead of time on a pool of its own, see prefetch()
+class CharProfileCache : public QObject
+{
+  Q_OBJECT
+
+public:
+  CharProfileCache(QObject *parent = nullptr);
+  ~CharProfileCache();
+
+  //p_path is the full path of the char.ini. a missing file gives an empty profile, which isn't kept
+  //so that the character is picked up as soon as it's installed
+  char_profile_type get_profile(QString p_path);
+
+  void clear();
+
+  //loads the profiles of p_chars in that order on the prefetch pool, a prefetch that is still running is abandoned
+  //p_character_path is the characters/ folder with a trailing slash. only as many as the cache holds are loaded,
+  //so put the likely ones first
+  void prefetch(QString p_character_path, QStringList p_chars);
+  void cancel_prefetch();
+  //how many char.ini files are read at the same time
+  void set_prefetch_threads(int p_threads);
+  //in number of characters
+  void set_max_profiles(int p_max_profiles);
+
+  //progress of the current (or last) prefetch, in characters
+  int get_prefetch_total() {return m_prefetch_total.loadAcquire();}
+  int get_prefetch_done() {return m_prefetch_done.loadAcquire();}
+
+private:
+  //in number of characters, until set_max_profiles() says otherwise
+  const int default_max_profiles = 64;
+
+  QCache<QString, char_profile_entry_type> m_profiles;
+  QMutex m_mutex;
+  QFileSystemWatcher *m_watcher;
+
+  //bumped whenever profiles are dropped. a profile parsed across a bump may be stale and isn't kept
+  int m_generation = 0;
+
+  QThreadPool m_prefetch_pool;
+  QSharedPointer<char_prefetch_job_type> m_prefetch_job;
+  QElapsedTimer m_prefetch_timer;
+
+  QAtomicInt m_prefetch_total;
+  QAtomicInt m_prefetch_done;
+  //the ones that weren't cached already
+  QAtomicInt m_prefetch_parsed;
+
+  friend class CharPrefetchTask;
+  friend struct char_profile_entry_type;
+
+  //returns false if the profile was cached already. r_profile may be nullptr
+  bool load_profile(QString p_path, char_profile_type *r_profile);
+
+  //returns false if the file couldn't be opened
+  static bool parse_char_ini(QString p_path, char_profile_type *r_profile);
+  static void build_emote_list(QString p_path, char_profile_type *r_profile);
+
+private slots:
+  //the watcher belongs to the GUI thread, prefetch threads queue their calls to this
+  void watch(QString p_path);
+  void unwatch(QString p_path);
+  void on_prefetch_finished();
+
+  void on_file_changed(QString p_path);
+};
+
+#endif // CHARPROFILECACHE_H
@@ -121,13 +121,26 @@ void Courtroom::set_char_select_page()
   if (current_char_page > 0)
     ui_char_select_left->show();
 
+  const QBitArray &f_inis = asset_scanner->get_char_inis();
+  const QBitArray &f_icons = asset_scanner->get_char_icons();
+  bool f_scanned = asset_scanner->is_ready() && f_inis.size() == char_list.size();
+
   for (int n_button = 0 ; n_button < chars_on_page ; ++n_button)
   {
     int n_real_char = n_button + current_char_page * max_chars_on_page;
     AOCharButton *f_button = ui_char_button_list.at(n_button);
 
     f_button->reset();
-    f_button->set_image(char_list.at(n_real_char).name);
+
+    if (f_scanned && !f_icons.testBit(n_real_char))
+      f_button->set_name(char_list.at(n_real_char).name);
+    else
+      f_button->set_image(char_list.at(n_real_char).name);
+
+    //there's no char.ini to play this character with
+    if (f_scanned && !f_inis.testBit(n_real_char))
+      f_button->set_missing();
+
     f_button->show();
 
     if (char_list.at(n_real_char).taken)
@@ -140,7 +153,7 @@ void Courtroom::char_clicked(int n_char)
 {
   int n_real_char = n_char + current_char_page * max_chars_on_page;
 
-  QString char_ini_path = ao_app->get_character_path(char_list.at(n_real_char).name) + "char.ini";
+  QString char_ini_path = resolve_path(ao_app->get_character_path(char_list.at(n_real_char).name) + "char.ini");
   qDebug() << "char_ini_path" << char_ini_path;
 
   if (!file_exists(char_ini_path))
@@ -0,0 +1,126 @@
+#include "configstore.h"
+
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QStringList>
+#include <QMutexLocker>
+
+ConfigStore::ConfigStore(QString p_path, QObject *parent) : QObject(parent)
+{
+  m_path = p_path;
+  m_values = parse_config(m_path);
+
+  m_watcher = new QFileSystemWatcher(this);
+
+  connect(m_watcher, SIGNAL(fileChanged(QString)), this, SLOT(on_file_changed()));
+  connect(m_watcher, SIGNAL(directoryChanged(QString)), this, SLOT(on_file_changed()));
+
+  watch();
+}
+
+QString ConfigStore::get_value(QString p_key)
+{
+  QMutexLocker locker(&m_mutex);
+
+  return m_values.value(p_key);
+}
+
+int ConfigStore::get_int(QString p_key, int p_default)
+{
+  QString f_result = get_value(p_key);
+
+  if (f_result == "")
+    return p_default;
+  else return f_result.toInt();
+}
+
+bool ConfigStore::get_bool(QString p_key)
+{
+  return get_value(p_key).startsWith("true");
+}
+
+void ConfigStore::reload()
+{
+  QHash<QString, QString> f_values = parse_config(m_path);
+  QStringList f_changed_keys;
+
+  {
+    QMutexLocker locker(&m_mutex);
+
+    for (QHash<QString, QString>::const_iterator i_value = f_values.constBegin() ; i_value != f_values.constEnd() ; ++i_value)
+    {
+      if (!m_values.contains(i_value.key()) || m_values.value(i_value.key()) != i_value.value())
+        f_changed_keys.append(i_value.key());
+    }
+
+    for (QHash<QString, QString>::const_iterator i_value = m_values.constBegin() ; i_value != m_values.constEnd() ; ++i_value)
+    {
+      if (!f_values.contains(i_value.key()))
+        f_changed_keys.append(i_value.key());
+    }
+
+    m_values = f_values;
+  }
+
+  //emitted without the lock held, receivers are going to read the new values
+  for (QString i_key : f_changed_keys)
+    emit value_changed(i_key);
+}
+
+//the file itself is watched while it exists, otherwise the folder it's supposed to be in
+void ConfigStore::watch()
+{
+  QFileInfo f_info(m_path);
+
+  if (f_info.exists())
+  {
+    if (!m_watcher->files().contains(m_path))
+      m_watcher->addPath(m_path);
+  }
+  else if (f_info.dir().exists())
+  {
+    if (!m_watcher->directories().contains(f_info.path()))
+      m_watcher->addPath(f_info.path());
+  }
+}
+
+void ConfigStore::on_file_changed()
+{
+  //editors that save with a temp file and a rename make the watcher drop the file
+  watch();
+
+  reload();
+}
+
+//same rules as the old read_config: lines are trimmed, keys are case sensitive and the first line for a key counts
+QHash<QString, QString> ConfigStore::parse_config(QString p_path)
+{
+  QHash<QString, QString> f_values;
+
+  QFile config_file(p_path);
+  if (!config_file.open(QIODevice::ReadOnly))
+    return f_values;
+
+  QTextStream in(&config_file);
+
+  while (!in.atEnd())
+  {
+    QString f_line = in.readLine().trimmed();
+
+    QStringList line_elements = f_line.split("=");
+
+    if (line_elements.size() < 2)
+      continue;
+
+    QString f_key = line_elements.at(0).trimmed();
+
+    if (!f_values.contains(f_key))
+      f_values.insert(f_key, line_elements.at(1).trimmed());
+  }
+
+  config_file.close();
+
+  return f_values;
+}
@@ -0,0 +1,41 @@
+#ifndef CONFIGSTORE_H
+#define CONFIGSTORE_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QFileSystemWatcher>
+
+//config.ini, parsed once and kept up to date with the file on disk
+//value_changed is emitted for every key whose value differs after the file was edited
+class ConfigStore : public QObject
+{
+  Q_OBJECT
+
+public:
+  ConfigStore(QString p_path, QObject *parent = nullptr);
+
+  //the empty string if the key isn't there
+  QString get_value(QString p_key);
+  int get_int(QString p_key, int p_default);
+  bool get_bool(QString p_key);
+
+signals:
+  void value_changed(QString p_key);
+
+private:
+  QString m_path;
+  QHash<QString, QString> m_values;
+  QMutex m_mutex;
+  QFileSystemWatcher *m_watcher;
+
+  void reload();
+  void watch();
+
+  static QHash<QString, QString> parse_config(QString p_path);
+
+private slots:
+  void on_file_changed();
+};
+
+#endif // CONFIGSTORE_H
@@ -0,0 +1,129 @@
+#include "connectionracer.h"
+
+#include <QDebug>
+
+ConnectionRacer::ConnectionRacer(QObject *parent) : QObject(parent)
+{
+  stagger_timer = new QTimer(this);
+  stagger_timer->setSingleShot(true);
+  timeout_timer = new QTimer(this);
+  timeout_timer->setSingleShot(true);
+
+  connect(stagger_timer, SIGNAL(timeout()), this, SLOT(start_next_candidate()));
+  connect(timeout_timer, SIGNAL(timeout()), this, SLOT(on_timeout()));
+}
+
+void ConnectionRacer::start(QVector<QPair<QString, quint16>> p_targets)
+{
+  cancel();
+
+  if (p_targets.isEmpty())
+  {
+    emit finished(nullptr);
+    return;
+  }
+
+  m_pending = p_targets;
+
+  start_next_candidate();
+}
+
+void ConnectionRacer::cancel()
+{
+  stagger_timer->stop();
+  timeout_timer->stop();
+  m_pending.clear();
+
+  for (QTcpSocket *i_socket : m_candidates)
+  {
+    i_socket->disconnect(this);
+    i_socket->abort();
+    i_socket->deleteLater();
+  }
+
+  m_candidates.clear();
+}
+
+void ConnectionRacer::start_next_candidate()
+{
+  stagger_timer->stop();
+
+  if (m_pending.isEmpty())
+    return;
+
+  QPair<QString, quint16> f_target = m_pending.takeFirst();
+
+  QTcpSocket *f_socket = create_socket(f_target.first, f_target.second);
+  m_candidates.append(f_socket);
+
+  connect(f_socket, SIGNAL(connected()), this, SLOT(on_candidate_connected()));
+  connect(f_socket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(on_candidate_error()));
+
+  if (!m_pending.isEmpty())
+    stagger_timer->start(stagger_milliseconds);
+
+  //the deadline always counts from the most recently started target
+  timeout_timer->start(timeout_milliseconds);
+
+  qDebug() << "Connecting to " << f_target.first << ":" << f_target.second;
+  f_socket->connectToHost(f_target.first, f_target.second);
+}
+
+QTcpSocket *ConnectionRacer::create_socket(QString p_host, quint16 p_port)
+{
+  Q_UNUSED(p_host);
+  Q_UNUSED(p_port);
+
+  return new QTcpSocket(this);
+}
+
+void ConnectionRacer::on_candidate_connected()
+{
+  QTcpSocket *f_socket = qobject_cast<QTcpSocket*>(sender());
+
+  if (f_socket == nullptr || !m_candidates.contains(f_socket))
+    return;
+
+  finish(f_socket);
+}
+
+void ConnectionRacer::on_candidate_error()
+{
+  QTcpSocket *f_socket = qobject_cast<QTcpSocket*>(sender());
+
+  if (f_socket == nullptr || !m_candidates.contains(f_socket))
+    return;
+
+  qWarning() << "Error connecting to" << f_socket->peerName() << ":" << f_socket->errorString();
+
+  m_candidates.removeOne(f_socket);
+  f_socket->disconnect(this);
+  f_socket->abort();
+  f_socket->deleteLater();
+
+  if (!m_pending.isEmpty())
+    start_next_candidate();
+  else if (m_candidates.isEmpty())
+    finish(nullptr);
+}
+
+void ConnectionRacer::on_timeout()
+{
+  qWarning() << "Connecting timed out.";
+
+  finish(nullptr);
+}
+
+//p_socket is the candidate that connected, or nullptr if every target failed
+void ConnectionRacer::finish(QTcpSocket *p_socket)
+{
+  if (p_socket != nullptr)
+  {
+    m_candidates.removeOne(p_socket);
+    p_socket->disconnect(this);
+  }
+
+  cancel();
+
+  emit finished(p_socket);
+}
@@ -0,0 +1,59 @@
+#ifndef CONNECTIONRACER_H
+#define CONNECTIONRACER_H
+
+#include <QObject>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QVector>
+#include <QPair>
+#include <QString>
+
+//connects to whichever of a list of targets answers first, happy eyeballs style: every target gets a short head start,
+//after which the next one is tried alongside it. a target that fails outright hands over right away
+class ConnectionRacer : public QObject
+{
+  Q_OBJECT
+
+public:
+  ConnectionRacer(QObject *parent = nullptr);
+
+  //host and port, in the order they should be tried. a race that is still running is called off
+  void start(QVector<QPair<QString, quint16>> p_targets);
+  void cancel();
+
+  //head start each target gets before the next one is tried alongside it
+  void set_stagger(int p_milliseconds) {stagger_milliseconds = p_milliseconds;}
+  //how long the last started target gets before the race is given up
+  void set_timeout(int p_milliseconds) {timeout_milliseconds = p_milliseconds;}
+
+signals:
+  //p_socket is the one that connected, still parented to the racer. nullptr if every target failed
+  void finished(QTcpSocket *p_socket);
+
+protected:
+  //the socket that is about to race for p_host:p_port, parented to the racer. tests hand out sockets
+  //that never connect here, which no real address does reliably
+  virtual QTcpSocket *create_socket(QString p_host, quint16 p_port);
+
+private:
+  int stagger_milliseconds = 250;
+  int timeout_milliseconds = 2000;
+
+  //targets that have not been tried yet
+  QVector<QPair<QString, quint16>> m_pending;
+  //sockets still racing to connect
+  QVector<QTcpSocket*> m_candidates;
+
+  QTimer *stagger_timer;
+  QTimer *timeout_timer;
+
+  void finish(QTcpSocket *p_socket);
+
+private slots:
+  void start_next_candidate();
+  void on_candidate_connected();
+  void on_candidate_error();
+  void on_timeout();
+};
+
+#endif // CONNECTIONRACER_H
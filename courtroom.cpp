@@ -1,6 +1,8 @@
 #include "courtroom.h"
 
 #include "aoapplication.h"
+#include "configstore.h"
+#include "callwordmatcher.h"
 #include "lobby.h"
 #include "hardware_functions.h"
 #include "file_functions.h"
@@ -23,6 +25,8 @@ Courtroom::Courtroom(AOApplication *p_ao_app) : QMainWindow()
   keepalive_timer = new QTimer(this);
   keepalive_timer->start(60000);
 
+  asset_scanner = new AssetScanner(ao_app, this);
+
   chat_tick_timer = new QTimer(this);
 
   text_delay_timer = new QTimer(this);
@@ -195,6 +199,8 @@ Courtroom::Courtroom(AOApplication *p_ao_app) : QMainWindow()
   construct_char_select();
 
   connect(keepalive_timer, SIGNAL(timeout()), this, SLOT(ping_server()));
+  connect(asset_scanner, SIGNAL(finished()), this, SLOT(on_asset_scan_finished()));
+  connect(ao_app->config_store, SIGNAL(value_changed(QString)), this, SLOT(on_config_value_changed(QString)));
 
   connect(ui_vp_objection, SIGNAL(done()), this, SLOT(objection_done()));
   connect(ui_vp_player_char, SIGNAL(done()), this, SLOT(preanim_done()));
@@ -289,6 +295,21 @@ void Courtroom::set_mute_list()
   }
 }
 
+//picks up edits to config.ini while the courtroom is open
+void Courtroom::on_config_value_changed(QString p_key)
+{
+  if (p_key == "blip_rate")
+    blip_rate = ao_app->read_blip_rate();
+  else if (p_key == "blank_blip")
+    blank_blip = ao_app->get_blank_blip();
+  else if (p_key == "default_music")
+    ui_music_slider->setValue(ao_app->get_default_music());
+  else if (p_key == "default_sfx")
+    ui_sfx_slider->setValue(ao_app->get_default_sfx());
+  else if (p_key == "default_blip")
+    ui_blip_slider->setValue(ao_app->get_default_blip());
+}
+
 void Courtroom::set_widgets()
 {
   blip_rate = ao_app->read_blip_rate();
@@ -616,6 +637,8 @@ void Courtroom::done_received()
 {
   m_cid = -1;
 
+  asset_scanner->scan(char_list, music_list, evidence_list);
+
   music_player->set_volume(0);
   sfx_player->set_volume(0);
   objection_player->set_volume(0);
@@ -671,6 +694,11 @@ void Courtroom::enter_courtroom(int p_cid)
   current_emote_page = 0;
   current_emote = 0;
 
+  if (m_cid == -1)
+    emote_list.clear();
+  else
+    emote_list = ao_app->get_emote_list(current_char);
+
   if (m_cid == -1)
     ui_emotes->hide();
   else
@@ -730,6 +758,9 @@ void Courtroom::enter_courtroom(int p_cid)
 
   set_widgets();
 
+  //the player char widget has its final size now, which is what the frames are decoded at
+  prefetch_own_emotes();
+
   //ui_server_chatlog->setHtml(ui_server_chatlog->toHtml());
 
   ui_char_select_background->hide();
@@ -749,6 +780,10 @@ void Courtroom::list_music()
 
   int n_listed_songs = 0;
 
+  //the scan only answers for the list it was given
+  const QBitArray &f_found = asset_scanner->get_music();
+  bool f_scanned = asset_scanner->is_ready() && f_found.size() == music_list.size();
+
   for (int n_song = 0 ; n_song < music_list.size() ; ++n_song)
   {
     QString i_song = music_list.at(n_song);
@@ -757,9 +792,14 @@ void Courtroom::list_music()
     {
       ui_music_list->addItem(i_song);
 
-      QString song_path = ao_app->get_base_path() + "sounds/music/" + i_song.toLower();
+      bool f_exists;
 
-      if (file_exists(song_path))
+      if (f_scanned)
+        f_exists = f_found.testBit(n_song);
+      else
+        f_exists = file_exists(ao_app->get_music_path(i_song));
+
+      if (f_exists)
         ui_music_list->item(n_listed_songs)->setBackground(found_brush);
       else
         ui_music_list->item(n_listed_songs)->setBackground(missing_brush);
@@ -809,30 +849,32 @@ void Courtroom::on_chat_return_pressed()
 
   QString f_side = ao_app->get_char_side(current_char);
 
+  emote_type f_emote = emote_list.value(current_emote);
+
   QString f_desk_mod = "chat";
 
   if (ao_app->desk_mod_enabled)
   {
-    f_desk_mod = QString::number(ao_app->get_desk_mod(current_char, current_emote));
+    f_desk_mod = QString::number(f_emote.desk_mod);
     if (f_desk_mod == "-1")
       f_desk_mod = "chat";
   }
 
   packet_contents.append(f_desk_mod);
 
-  packet_contents.append(ao_app->get_pre_emote(current_char, current_emote));
+  packet_contents.append(f_emote.preanim);
 
   packet_contents.append(current_char);
 
-  packet_contents.append(ao_app->get_emote(current_char, current_emote));
+  packet_contents.append(f_emote.anim);
 
   packet_contents.append(ui_ic_chat_message->text());
 
   packet_contents.append(f_side);
 
-  packet_contents.append(ao_app->get_sfx_name(current_char, current_emote));
+  packet_contents.append(f_emote.sfx_name);
 
-  int f_emote_mod = ao_app->get_emote_mod(current_char, current_emote);
+  int f_emote_mod = f_emote.mod;
 
   //needed or else legacy won't understand what we're saying
   if (objection_state > 0)
@@ -860,7 +902,7 @@ void Courtroom::on_chat_return_pressed()
   packet_contents.append(QString::number(f_emote_mod));
   packet_contents.append(QString::number(m_cid));
 
-  packet_contents.append(QString::number(ao_app->get_sfx_delay(current_char, current_emote)));
+  packet_contents.append(QString::number(f_emote.sfx_delay));
 
   QString f_obj_state;
 
@@ -928,14 +970,14 @@ void Courtroom::cd() {
     ui_evidence_present->set_image("present_disabled.png");
 }
 
-void Courtroom::handle_chatmessage(QStringList *p_contents)
+void Courtroom::handle_chatmessage(AOPacket *p_packet)
 {
-  if (p_contents->size() < chatmessage_size)
+  if (p_packet->get_field_count() < chatmessage_size)
     return;
 
   for (int n_string = 0 ; n_string < chatmessage_size ; ++n_string)
   {
-    m_chatmessage[n_string] = p_contents->at(n_string);
+    m_chatmessage[n_string] = p_packet->get_field(n_string);
   }
 
   int f_char_id = m_chatmessage[CHAR_ID].toInt();
@@ -970,6 +1012,8 @@ void Courtroom::handle_chatmessage(QStringList *p_contents)
   QString f_char = m_chatmessage[CHAR_NAME];
   QString f_custom_theme = ao_app->get_char_shouts(f_char);
 
+  prefetch_chatmessage_anims();
+
   //if an objection is used
   if (objection_mod <= 4 && objection_mod >= 1)
   {
@@ -1005,6 +1049,51 @@ void Courtroom::handle_chatmessage(QStringList *p_contents)
     handle_chatmessage_2();
 }
 
+void Courtroom::prefetch_chatmessage_anims()
+{
+  //decoding starts now, so that it can happen while the objection and the preanim are playing
+  QString f_char = m_chatmessage[CHAR_NAME];
+  QString f_emote = m_chatmessage[EMOTE];
+  int emote_mod = m_chatmessage[EMOTE_MOD].toInt();
+  bool f_flipped = ao_app->flipping_enabled && m_chatmessage[FLIP].toInt() == 1;
+
+  if (emote_mod == 1 || emote_mod == 2 || emote_mod == 6)
+    ui_vp_player_char->prefetch(f_char, m_chatmessage[PRE_EMOTE], "", f_flipped);
+
+  ui_vp_player_char->prefetch(f_char, f_emote, "(b)", f_flipped);
+  ui_vp_player_char->prefetch(f_char, f_emote, "(a)", f_flipped);
+}
+
+void Courtroom::prefetch_own_emotes()
+{
+  //only what is about to be picked from. all emotes of a big character would be hundreds of decodes that
+  //get in the way of the ones being waited on, and push whatever is on screen out of the frame cache
+  prefetch_own_emote(current_emote);
+
+  int f_first = current_emote_page * max_emotes_on_page;
+
+  for (int n_emote = f_first ; n_emote < f_first + max_emotes_on_page && n_emote < emote_list.size() ; ++n_emote)
+  {
+    if (n_emote != current_emote)
+      prefetch_own_emote(n_emote);
+  }
+}
+
+void Courtroom::prefetch_own_emote(int p_emote)
+{
+  if (p_emote < 0 || p_emote >= emote_list.size())
+    return;
+
+  emote_type f_emote = emote_list.at(p_emote);
+  bool f_flipped = ao_app->flipping_enabled && ui_flip->isChecked();
+
+  if (f_emote.preanim != "" && f_emote.preanim != "-")
+    ui_vp_player_char->prefetch(current_char, f_emote.preanim, "", f_flipped);
+
+  ui_vp_player_char->prefetch(current_char, f_emote.anim, "(b)", f_flipped);
+  ui_vp_player_char->prefetch(current_char, f_emote.anim, "(a)", f_flipped);
+}
+
 void Courtroom::objection_done()
 {
   handle_chatmessage_2();
@@ -1130,18 +1219,10 @@ void Courtroom::handle_chatmessage_3()
     sfx_player->play(ao_app->get_sfx("realization"));
   }
 
-  QString f_message = m_chatmessage[MESSAGE];
-  QStringList call_words = ao_app->get_call_words();
-
-  for (QString word : call_words)
+  if (ao_app->call_words->matches(m_chatmessage[MESSAGE]))
   {
-    if (f_message.contains(word, Qt::CaseInsensitive))
-    {
-      modcall_player->play(ao_app->get_sfx("word_call"));
-      ao_app->alert(this);
-
-      break;
-    }
+    modcall_player->play(ao_app->get_sfx("word_call"));
+    ao_app->alert(this);
   }
 
 }
@@ -1191,12 +1272,13 @@ void Courtroom::play_preanim()
 
   sfx_delay_timer->start(sfx_delay);
 
-  if (!file_exists(ao_app->get_character_path(f_char) + f_preanim.toLower() + ".gif") ||
-      preanim_duration < 0)
+  QString f_preanim_path = resolve_path(ao_app->get_character_path(f_char) + f_preanim + ".gif");
+
+  if (!file_exists(f_preanim_path) || preanim_duration < 0)
   {
     anim_state = 1;
     preanim_done();
-    qDebug() << "could not find " + ao_app->get_character_path(f_char) + f_preanim.toLower() + ".gif";
+    qDebug() << "could not find " + f_preanim_path;
     return;
   }
 
@@ -2042,6 +2124,14 @@ void Courtroom::ping_server()
   ao_app->send_server_packet(new AOPacket("CH#" + QString::number(m_cid) + "#%"));
 }
 
+void Courtroom::on_asset_scan_finished()
+{
+  if (ui_char_select_background->isVisible())
+    set_char_select_page();
+
+  list_music();
+}
+
 Courtroom::~Courtroom()
 {
   delete music_player;
@@ -17,6 +17,7 @@
 #include "aolineedit.h"
 #include "aotextedit.h"
 #include "aoevidencedisplay.h"
+#include "assetscanner.h"
 #include "datatypes.h"
 
 #include <QMainWindow>
@@ -45,6 +46,10 @@ public:
   void append_evidence(evi_type p_evi){evidence_list.append(p_evi);}
   void append_music(QString f_music){music_list.append(f_music);}
 
+  const QVector<char_type>& get_char_list() {return char_list;}
+  const QVector<evi_type>& get_evidence_list() {return evidence_list;}
+  const QVector<QString>& get_music_list() {return music_list;}
+
   void set_widgets();
   void set_font(QWidget *widget, QString p_identifier);
   void set_fonts();
@@ -82,7 +87,7 @@ public:
   void append_ms_chatmessage(QString f_name, QString f_message);
   void append_server_chatmessage(QString p_name, QString p_message);
 
-  void handle_chatmessage(QStringList *p_contents);
+  void handle_chatmessage(AOPacket *p_packet);
   void handle_chatmessage_2();
   void handle_chatmessage_3();
 
@@ -92,6 +97,12 @@ public:
 
   void play_preanim();
 
+  //start decoding the animations of the current message and of our own character in the background
+  void prefetch_chatmessage_anims();
+  //the selected emote and the rest of the current emote page
+  void prefetch_own_emotes();
+  void prefetch_own_emote(int p_emote);
+
   void handle_wtce(QString p_wtce);
   void set_hp_bar(int p_bar, int p_state);
 
@@ -119,6 +130,9 @@ private:
 
   QSignalMapper *char_button_mapper;
 
+  //knows which of the lists above exist locally once the scan started in done_received() is through
+  AssetScanner *asset_scanner;
+
   //triggers ping_server() every 60 seconds
   QTimer *keepalive_timer;
 
@@ -193,6 +207,8 @@ private:
 
   int current_emote_page = 0;
   int current_emote = 0;
+  //emotes of current_char, read once in enter_courtroom()
+  QVector<emote_type> emote_list;
   int emote_columns = 5;
   int emote_rows = 2;
   int max_emotes_on_page = 10;
@@ -361,6 +377,9 @@ public slots:
   void mod_called(QString p_ip);
 
 private slots:
+  void on_config_value_changed(QString p_key);
+  void on_asset_scan_finished();
+
   void start_chat_ticking();
   void play_sfx();
 
@@ -2,6 +2,8 @@
 #define DATATYPES_H
 
 #include <QString>
+#include <QHash>
+#include <QVector>
 
 struct server_type
 {
@@ -11,15 +13,17 @@ struct server_type
   int port;
 };
 
+//the defaults are what a misformatted or missing char.ini line gives
 struct emote_type
 {
-  QString comment;
-  QString preanim;
-  QString anim;
-  int mod;
-  QString sfx_name;
-  int sfx_delay;
-  int sfx_duration;
+  QString comment = "normal";
+  QString preanim = "";
+  QString anim = "normal";
+  int mod = 0;
+  int desk_mod = -1;
+  QString sfx_name = "1";
+  int sfx_delay = 1;
+  int sfx_duration = 0;
 };
 
 struct char_type
@@ -30,6 +34,21 @@ struct char_type
   bool taken;
 };
 
+//everything in a char.ini, one hash per section. keys are lowercase, values trimmed
+//if a key appears more than once in a section, the first one counts
+struct char_profile_type
+{
+  QHash<QString, QString> options;
+  QHash<QString, QString> time;
+  QHash<QString, QString> emotions;
+  QHash<QString, QString> sound_n;
+  QHash<QString, QString> sound_t;
+  QHash<QString, QString> text_delay;
+
+  //[Emotions] combined with [SoundN] and [SoundT], index 0 is emote 1
+  QVector<emote_type> emote_list;
+};
+
 struct evi_type
 {
   QString name;
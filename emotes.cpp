@@ -53,7 +53,7 @@ void Courtroom::set_emote_page()
   if (m_cid == -1)
     return;
 
-  int total_emotes = ao_app->get_emote_number(current_char);
+  int total_emotes = emote_list.size();
 
   ui_emote_left->hide();
   ui_emote_right->hide();
@@ -90,10 +90,12 @@ void Courtroom::set_emote_page()
     int n_real_emote = n_emote + current_emote_page * max_emotes_on_page;
     AOEmoteButton *f_emote = ui_emote_list.at(n_emote);
 
+    QString f_comment = emote_list.at(n_real_emote).comment;
+
     if (n_real_emote == current_emote)
-      f_emote->set_image(current_char, n_real_emote, "_on.png");
+      f_emote->set_image(current_char, n_real_emote, f_comment, "_on.png");
     else
-      f_emote->set_image(current_char, n_real_emote, "_off.png");
+      f_emote->set_image(current_char, n_real_emote, f_comment, "_off.png");
 
     f_emote->show();
   }
@@ -104,15 +106,14 @@ void Courtroom::set_emote_dropdown()
 {
   ui_emote_dropdown->clear();
 
-  int total_emotes = ao_app->get_emote_number(current_char);
-  QStringList emote_list;
+  QStringList f_comments;
 
-  for (int n = 0 ; n < total_emotes ; ++n)
+  for (const emote_type &i_emote : emote_list)
   {
-    emote_list.append(ao_app->get_emote_comment(current_char, n));
+    f_comments.append(i_emote.comment);
   }
 
-  ui_emote_dropdown->addItems(emote_list);
+  ui_emote_dropdown->addItems(f_comments);
 }
 
 void Courtroom::select_emote(int p_id)
@@ -121,16 +122,16 @@ void Courtroom::select_emote(int p_id)
   int max = (max_emotes_on_page - 1) + current_emote_page * max_emotes_on_page;
 
   if (current_emote >= min && current_emote <= max)
-    ui_emote_list.at(current_emote % max_emotes_on_page)->set_image(current_char, current_emote, "_off.png");
+    ui_emote_list.at(current_emote % max_emotes_on_page)->set_image(current_char, current_emote, emote_list.value(current_emote).comment, "_off.png");
 
   int old_emote = current_emote;
 
   current_emote = p_id;
 
   if (current_emote >= min && current_emote <= max)
-    ui_emote_list.at(current_emote % max_emotes_on_page)->set_image(current_char, current_emote, "_on.png");
+    ui_emote_list.at(current_emote % max_emotes_on_page)->set_image(current_char, current_emote, emote_list.value(current_emote).comment, "_on.png");
 
-  int emote_mod = ao_app->get_emote_mod(current_char, current_emote);
+  int emote_mod = emote_list.value(current_emote).mod;
 
   if (old_emote == current_emote)
   {
@@ -143,6 +144,8 @@ void Courtroom::select_emote(int p_id)
 
   ui_emote_dropdown->setCurrentIndex(current_emote);
 
+  prefetch_own_emote(current_emote);
+
   ui_ic_chat_message->setFocus();
 }
 
@@ -156,6 +159,7 @@ void Courtroom::on_emote_left_clicked()
   --current_emote_page;
 
   set_emote_page();
+  prefetch_own_emotes();
 
   ui_ic_chat_message->setFocus();
 }
@@ -166,6 +170,7 @@ void Courtroom::on_emote_right_clicked()
   ++current_emote_page;
 
   set_emote_page();
+  prefetch_own_emotes();
 
   ui_ic_chat_message->setFocus();
 }
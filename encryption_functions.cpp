@@ -1,69 +1,106 @@
 #include "encryption_functions.h"
 
-#include "hex_functions.h"
+#include <QByteArray>
 
-#include <cstddef>
-#include <stdlib.h>
-#include <sstream>
-#include <iomanip>
-#include <QVector>
+static const unsigned int C1 = 53761;
+static const unsigned int C2 = 32618;
 
-QString fanta_encrypt(QString temp_input, unsigned int p_key)
+//every byte maps straight to its two uppercase hex digits, and every character to its nibble value (-1 if it isn't one)
+struct hex_table_type
 {
-  //using standard stdlib types is actually easier here because of implicit char<->int conversion
-  //which in turn makes encryption arithmetic easier
+  hex_table_type()
+  {
+    const char f_digits[] = "0123456789ABCDEF";
+
+    for (int n_byte = 0 ; n_byte < 256 ; ++n_byte)
+    {
+      pairs[n_byte][0] = f_digits[n_byte >> 4];
+      pairs[n_byte][1] = f_digits[n_byte & 15];
+      nibbles[n_byte] = -1;
+    }
+
+    for (int n_digit = 0 ; n_digit < 10 ; ++n_digit)
+      nibbles['0' + n_digit] = n_digit;
+
+    for (int n_digit = 0 ; n_digit < 6 ; ++n_digit)
+    {
+      nibbles['A' + n_digit] = 10 + n_digit;
+      nibbles['a' + n_digit] = 10 + n_digit;
+    }
+  }
 
-  unsigned int key = p_key;
-  unsigned int C1 = 53761;
-  unsigned int C2 = 32618;
+  char pairs[256][2];
+  signed char nibbles[256];
+};
 
-  QVector<uint_fast8_t> temp_result;
-  std::string input = temp_input.toUtf8().constData();
+static const hex_table_type hex_table;
 
-  for (unsigned int pos = 0 ; pos < input.size() ; ++pos)
-  {
-    uint_fast8_t output = input.at(pos) ^ (key >> 8) % 256;
-    temp_result.append(output);
-    key = (temp_result.at(pos) + key) * C1 + C2;
-  }
+static QByteArray encrypt_bytes(const QByteArray &p_input, unsigned int p_key)
+{
+  const unsigned char *f_input = reinterpret_cast<const unsigned char*>(p_input.constData());
+  int f_size = p_input.size();
 
-  std::string result = "";
+  QByteArray f_result(f_size * 2, Qt::Uninitialized);
+  char *f_output = f_result.data();
 
-  for (uint_fast8_t i_int : temp_result)
+  unsigned int key = p_key;
+
+  for (int pos = 0 ; pos < f_size ; ++pos)
   {
-    result += omni::int_to_hex(i_int);
-  }
+    unsigned char f_byte = f_input[pos] ^ ((key >> 8) % 256);
 
-  QString final_result = QString::fromStdString(result);
+    f_output[pos * 2] = hex_table.pairs[f_byte][0];
+    f_output[pos * 2 + 1] = hex_table.pairs[f_byte][1];
 
-  return final_result;
+    key = (f_byte + key) * C1 + C2;
+  }
+
+  return f_result;
 }
 
-QString fanta_decrypt(QString temp_input, unsigned int key)
+static QByteArray decrypt_bytes(const QByteArray &p_input, unsigned int p_key)
 {
-  std::string input = temp_input.toUtf8().constData();
+  const unsigned char *f_input = reinterpret_cast<const unsigned char*>(p_input.constData());
+  int f_size = p_input.size();
 
-  QVector<unsigned int> unhexed_vector;
+  QByteArray f_result((f_size + 1) / 2, Qt::Uninitialized);
+  char *f_output = f_result.data();
 
-  for(unsigned int i=0; i< input.length(); i+=2)
+  unsigned int key = p_key;
+
+  for (int pos = 0 ; pos < f_size ; pos += 2)
   {
-    std::string byte = input.substr(i,2);
-    unsigned int hex_int = strtoul(byte.c_str(), nullptr, 16);
-    unhexed_vector.append(hex_int);
-  }
+    //same as strtoul on the pair: parsing stops at the first character that isn't a hex digit
+    unsigned int f_value = 0;
+    int f_high = hex_table.nibbles[f_input[pos]];
 
-  unsigned int C1 = 53761;
-  unsigned int C2 = 32618;
+    if (f_high >= 0)
+    {
+      f_value = f_high;
 
-  std::string result = "";
+      if (pos + 1 < f_size)
+      {
+        int f_low = hex_table.nibbles[f_input[pos + 1]];
 
-  for (int pos = 0 ; pos < unhexed_vector.size() ; ++pos)
-  {
-    unsigned char output = unhexed_vector.at(pos) ^ (key >> 8) % 256;
-    result += output;
-    key = (unhexed_vector.at(pos) + key) * C1 + C2;
+        if (f_low >= 0)
+          f_value = f_value * 16 + f_low;
+      }
+    }
+
+    f_output[pos / 2] = static_cast<char>(f_value ^ ((key >> 8) % 256));
+
+    key = (f_value + key) * C1 + C2;
   }
 
-  return QString::fromStdString(result);
+  return f_result;
+}
 
+QString fanta_encrypt(QString temp_input, unsigned int p_key)
+{
+  return QString::fromLatin1(encrypt_bytes(temp_input.toUtf8(), p_key));
+}
+
+QString fanta_decrypt(QString temp_input, unsigned int key)
+{
+  return QString::fromUtf8(decrypt_bytes(temp_input.toUtf8(), key));
 }
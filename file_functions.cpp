@@ -1,18 +1,94 @@
 #include <QFileInfo>
 #include <QDir>
+#include <QResource>
+#include <QFile>
 
 #include "file_functions.h"
+#include "assetindex.h"
+
+static AssetIndex *asset_index = nullptr;
+
+void set_asset_index(AssetIndex *p_index)
+{
+  asset_index = p_index;
+}
+
+QString resolve_path(QString p_path)
+{
+  if (asset_index == nullptr)
+    return p_path;
+
+  return asset_index->resolve(p_path);
+}
 
 bool file_exists(QString file_path)
 {
+  if (asset_index != nullptr)
+  {
+    AssetIndex::lookup_result f_result = asset_index->lookup(file_path);
+
+    if (f_result != AssetIndex::UNKNOWN)
+    {
+      asset_index->count_lookup(true, f_result == AssetIndex::FOUND_FILE);
+      return f_result == AssetIndex::FOUND_FILE;
+    }
+  }
+
   QFileInfo check_file(file_path);
 
-  return check_file.exists() && check_file.isFile();
+  bool f_exists = check_file.exists() && check_file.isFile();
+
+  if (asset_index != nullptr)
+    asset_index->count_lookup(false, f_exists);
+
+  return f_exists;
 }
 
 bool dir_exists(QString dir_path)
 {
+  if (asset_index != nullptr)
+  {
+    AssetIndex::lookup_result f_result = asset_index->lookup(dir_path);
+
+    if (f_result != AssetIndex::UNKNOWN)
+    {
+      asset_index->count_lookup(true, f_result == AssetIndex::FOUND_DIRECTORY);
+      return f_result == AssetIndex::FOUND_DIRECTORY;
+    }
+  }
+
   QDir check_dir(dir_path);
 
-  return check_dir.exists();
+  bool f_exists = check_dir.exists();
+
+  if (asset_index != nullptr)
+    asset_index->count_lookup(false, f_exists);
+
+  return f_exists;
+}
+
+bool is_packed_path(QString p_path)
+{
+  return p_path.startsWith(":/");
+}
+
+QByteArray get_packed_file(QString p_path)
+{
+  QResource f_resource(p_path);
+
+  if (!f_resource.isValid())
+    return QByteArray();
+
+  //newer rcc compresses with zstd where Qt has it, QFile knows how to undo whichever it was
+  if (f_resource.isCompressed())
+  {
+    QFile f_file(p_path);
+
+    if (!f_file.open(QIODevice::ReadOnly))
+      return QByteArray();
+
+    return f_file.readAll();
+  }
+
+  return QByteArray::fromRawData(reinterpret_cast<const char*>(f_resource.data()), static_cast<int>(f_resource.size()));
 }
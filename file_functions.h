@@ -2,8 +2,23 @@
 #define FILE_FUNCTIONS_H
 
 #include <QString>
+#include <QByteArray>
+
+class AssetIndex;
+
+//once set, lookups under base/ are answered from the index instead of the file system
+void set_asset_index(AssetIndex *p_index);
+
+//p_path as it is spelled on disk. asset names are matched without regard to case
+QString resolve_path(QString p_path);
 
 bool file_exists(QString file_path);
 bool dir_exists(QString file_path);
 
+//resolve_path() hands out paths into an .aopack for files that are only packed. Qt reads those like
+//any other file, everything else has to take the data from get_packed_file()
+bool is_packed_path(QString p_path);
+//points straight into the mapped pack unless the entry is compressed, then it's a decompressed copy
+QByteArray get_packed_file(QString p_path);
+
 #endif // FILE_FUNCTIONS_H
@@ -0,0 +1,403 @@
+#include "framecache.h"
+
+#include "image_functions.h"
+
+#include <QImageReader>
+#include <QFile>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QDebug>
+
+//priorities in m_decode_pool, something that is about to be shown goes before a guess
+static const int demand_priority = 1;
+static const int prefetch_priority = 0;
+
+class FrameDecodeTask : public QRunnable
+{
+public:
+  FrameDecodeTask(FrameCache *p_cache, QString p_key, QString p_path, QSize p_size, bool p_flipped, bool p_smooth)
+  {
+    m_cache = p_cache;
+    m_key = p_key;
+    m_path = p_path;
+    m_size = p_size;
+    m_flipped = p_flipped;
+    m_smooth = p_smooth;
+  }
+
+  void run()
+  {
+    FrameCache::decoded_type f_decoded;
+
+    FrameCache::decode(m_path, m_size, m_flipped, m_smooth, f_decoded.images, f_decoded.delays);
+
+    {
+      QMutexLocker locker(&m_cache->m_mutex);
+      m_cache->m_decoded.insert(m_key, f_decoded);
+    }
+
+    QMetaObject::invokeMethod(m_cache, "on_decode_finished", Qt::QueuedConnection, Q_ARG(QString, m_key));
+  }
+
+private:
+  FrameCache *m_cache;
+  QString m_key;
+  QString m_path;
+  QSize m_size;
+  bool m_flipped;
+  bool m_smooth;
+};
+
+FrameCache::FrameCache(int p_max_kilobytes, QObject *p_parent) : QObject(p_parent)
+{
+  m_sets.setMaxCost(p_max_kilobytes);
+  m_decode_pool.setMaxThreadCount(2);
+}
+
+FrameCache::~FrameCache()
+{
+  //whatever hasn't started yet isn't needed anymore
+  m_decode_pool.clear();
+  m_decode_pool.waitForDone();
+}
+
+QSharedPointer<const frame_set_type> FrameCache::get_frames(QString p_path, QSize p_size, bool p_flipped)
+{
+  QString f_key = make_key(p_path, p_size, p_flipped);
+
+  if (f_key == m_delivered_key)
+    return m_delivered_set;
+
+  QMutexLocker locker(&m_mutex);
+
+  cache_entry_type *f_entry = m_sets.object(f_key);
+
+  if (f_entry != nullptr)
+  {
+    m_hits.fetchAndAddRelaxed(1);
+    return f_entry->frame_set;
+  }
+
+  m_misses.fetchAndAddRelaxed(1);
+
+  queue_decode(f_key, p_path, p_size, p_flipped, demand_priority);
+
+  return QSharedPointer<const frame_set_type>();
+}
+
+QSharedPointer<const frame_set_type> FrameCache::get_first_frame(QString p_path, QSize p_size, bool p_flipped)
+{
+  QSharedPointer<frame_set_type> f_frame_set(new frame_set_type);
+  f_frame_set->complete = false;
+
+  QImageReader f_reader(p_path);
+  set_target_size(f_reader, p_size);
+
+  QImage f_image = f_reader.read();
+
+  if (f_image.isNull())
+    return f_frame_set;
+
+  QPixmap f_pixmap = QPixmap::fromImage(prepare_frame(f_image, p_size, p_flipped, m_smooth));
+
+  f_frame_set->frames.append(f_pixmap);
+  f_frame_set->delays.append(qMax(0, f_reader.nextImageDelay()));
+  f_frame_set->total_duration = f_frame_set->delays.at(0);
+  f_frame_set->byte_size = f_pixmap.width() * f_pixmap.height() * f_pixmap.depth() / 8;
+
+  return f_frame_set;
+}
+
+void FrameCache::prefetch(QString p_path, QSize p_size, bool p_flipped)
+{
+  QString f_key = make_key(p_path, p_size, p_flipped);
+
+  QMutexLocker locker(&m_mutex);
+
+  if (m_sets.contains(f_key) || m_pending.contains(f_key))
+    return;
+
+  m_prefetches.fetchAndAddRelaxed(1);
+
+  queue_decode(f_key, p_path, p_size, p_flipped, prefetch_priority);
+}
+
+void FrameCache::queue_decode(QString p_key, QString p_path, QSize p_size, bool p_flipped, int p_priority)
+{
+  //already on its way, possibly behind other prefetches if that's what queued it
+  if (m_pending.contains(p_key))
+    return;
+
+  m_pending.insert(p_key);
+  m_decode_pool.start(new FrameDecodeTask(this, p_key, p_path, p_size, p_flipped, m_smooth), p_priority);
+}
+
+void FrameCache::on_decode_finished(QString p_key)
+{
+  decoded_type f_decoded;
+
+  {
+    QMutexLocker locker(&m_mutex);
+
+    f_decoded = m_decoded.take(p_key);
+    m_pending.remove(p_key);
+  }
+
+  QSharedPointer<const frame_set_type> f_frame_set = make_frame_set(f_decoded.images, f_decoded.delays);
+
+  if (!f_frame_set->frames.isEmpty())
+    insert(p_key, f_frame_set);
+
+  m_delivered_key = p_key;
+  m_delivered_set = f_frame_set;
+
+  emit frames_ready(p_key);
+
+  m_delivered_key.clear();
+  m_delivered_set.clear();
+}
+
+void FrameCache::insert(QString p_key, QSharedPointer<const frame_set_type> p_frame_set)
+{
+  int f_kilobytes = qMax(1, p_frame_set->byte_size / 1024);
+  m_decoded_kilobytes.fetchAndAddRelaxed(f_kilobytes);
+
+  cache_entry_type *f_entry = new cache_entry_type;
+  f_entry->frame_set = p_frame_set;
+
+  QMutexLocker locker(&m_mutex);
+
+  //a set bigger than the whole budget is handed out but not kept, QCache deletes it right away
+  m_sets.insert(p_key, f_entry, f_kilobytes);
+}
+
+animation_info_type FrameCache::get_info(QString p_path)
+{
+  {
+    QMutexLocker locker(&m_mutex);
+
+    QHash<QString, animation_info_type>::const_iterator f_info = m_infos.constFind(p_path);
+
+    if (f_info != m_infos.constEnd())
+      return f_info.value();
+  }
+
+  animation_info_type f_info = read_info(p_path);
+
+  QMutexLocker locker(&m_mutex);
+
+  m_infos.insert(p_path, f_info);
+
+  return f_info;
+}
+
+void FrameCache::set_max_kilobytes(int p_max_kilobytes)
+{
+  QMutexLocker locker(&m_mutex);
+
+  m_sets.setMaxCost(p_max_kilobytes);
+}
+
+void FrameCache::set_decode_threads(int p_threads)
+{
+  m_decode_pool.setMaxThreadCount(qMax(1, p_threads));
+}
+
+void FrameCache::set_smooth_scaling(bool p_smooth)
+{
+  if (p_smooth == m_smooth)
+    return;
+
+  m_smooth = p_smooth;
+  clear();
+}
+
+void FrameCache::clear()
+{
+  QMutexLocker locker(&m_mutex);
+
+  m_sets.clear();
+  m_infos.clear();
+}
+
+void FrameCache::dump_stats()
+{
+  QMutexLocker locker(&m_mutex);
+
+  qDebug() << "frame cache stats (hits, misses, prefetches, KB decoded, KB cached, KB budget):"
+           << m_hits.loadAcquire() << m_misses.loadAcquire() << m_prefetches.loadAcquire()
+           << m_decoded_kilobytes.loadAcquire()
+           << m_sets.totalCost() << m_sets.maxCost();
+}
+
+QString FrameCache::make_key(QString p_path, QSize p_size, bool p_flipped)
+{
+  return p_path + "|" + QString::number(p_size.width()) + "x" + QString::number(p_size.height()) +
+         (p_flipped ? "|f" : "");
+}
+
+animation_info_type FrameCache::read_info(QString p_path)
+{
+  animation_info_type f_info;
+
+  QFile f_file(p_path);
+
+  if (!f_file.open(QIODevice::ReadOnly))
+    return f_info;
+
+  QByteArray f_header = f_file.peek(6);
+
+  //anything else is a still image as far as QImageReader is concerned, one frame that doesn't wait
+  if (f_header != "GIF87a" && f_header != "GIF89a")
+  {
+    f_info.frame_count = 1;
+    f_info.delays.append(0);
+    return f_info;
+  }
+
+  qint64 f_size = f_file.size();
+  uchar *f_data = f_file.map(0, f_size);
+
+  if (f_data != nullptr)
+  {
+    if (!scan_gif(f_data, f_size, f_info))
+      qDebug() << "W: could not make sense of" << p_path;
+
+    return f_info;
+  }
+
+  QByteArray f_contents = f_file.readAll();
+
+  if (!scan_gif(reinterpret_cast<const uchar*>(f_contents.constData()), f_contents.size(), f_info))
+    qDebug() << "W: could not make sense of" << p_path;
+
+  return f_info;
+}
+
+//returns false if the file ends early. whatever frames were complete by then are still in r_info
+bool FrameCache::scan_gif(const uchar *p_data, qint64 p_size, animation_info_type &r_info)
+{
+  //signature and logical screen descriptor
+  qint64 f_pos = 13;
+
+  if (p_size < f_pos)
+    return false;
+
+  //the global color table follows if the top bit of the packed field is set
+  if (p_data[10] & 0x80)
+    f_pos += 3 * (1 << ((p_data[10] & 0x07) + 1));
+
+  //same as Qt's GIF reader: 100 ms until the first graphic control extension says otherwise,
+  //and a frame without one of its own keeps the last delay
+  int f_delay = 100;
+
+  while (f_pos < p_size)
+  {
+    uchar f_block = p_data[f_pos++];
+
+    if (f_block == 0x3B)
+      return true;
+
+    if (f_block == 0x21)
+    {
+      if (f_pos >= p_size)
+        return false;
+
+      uchar f_label = p_data[f_pos++];
+
+      //graphic control extension: block size 4, packed field, delay in hundredths of a second
+      if (f_label == 0xF9 && f_pos + 4 < p_size && p_data[f_pos] == 4)
+        f_delay = (p_data[f_pos + 2] | (p_data[f_pos + 3] << 8)) * 10;
+    }
+    else if (f_block == 0x2C)
+    {
+      //image descriptor, then the local color table if there is one, then the lzw code size
+      if (f_pos + 9 > p_size)
+        return false;
+
+      uchar f_packed = p_data[f_pos + 8];
+      f_pos += 9;
+
+      if (f_packed & 0x80)
+        f_pos += 3 * (1 << ((f_packed & 0x07) + 1));
+
+      ++f_pos;
+
+      r_info.delays.append(f_delay);
+      r_info.total_duration += f_delay;
+      ++r_info.frame_count;
+    }
+    else
+      return false;
+
+    //both extensions and image data end in a chain of sub-blocks, each led by its length
+    while (true)
+    {
+      if (f_pos >= p_size)
+        return false;
+
+      uchar f_length = p_data[f_pos++];
+
+      if (f_length == 0)
+        break;
+
+      f_pos += f_length;
+    }
+  }
+
+  return false;
+}
+
+QImage FrameCache::prepare_frame(QImage p_image, QSize p_size, bool p_flipped, bool p_smooth)
+{
+  //before anything else, so that the rest only deals with the pixels that are kept
+  p_image = scale_image(p_image, p_size, p_smooth);
+
+  if (p_flipped)
+    p_image = p_image.mirrored(true, false);
+
+  //the format the raster engine draws fastest, so that fromImage() has nothing left to convert
+  if (p_image.format() != QImage::Format_ARGB32_Premultiplied)
+    p_image = p_image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+  return p_image;
+}
+
+void FrameCache::decode(QString p_path, QSize p_size, bool p_flipped, bool p_smooth,
+                        QVector<QImage> &r_images, QVector<int> &r_delays)
+{
+  QImageReader f_reader(p_path);
+  set_target_size(f_reader, p_size);
+
+  QImage f_image = f_reader.read();
+
+  while (!f_image.isNull())
+  {
+    //same order QMovie uses, the delay belongs to the frame that was just read
+    int f_delay = qMax(0, f_reader.nextImageDelay());
+
+    r_images.append(prepare_frame(f_image, p_size, p_flipped, p_smooth));
+    r_delays.append(f_delay);
+
+    f_image = f_reader.read();
+  }
+}
+
+QSharedPointer<const frame_set_type> FrameCache::make_frame_set(const QVector<QImage> &p_images, const QVector<int> &p_delays)
+{
+  QSharedPointer<frame_set_type> f_frame_set(new frame_set_type);
+
+  f_frame_set->frames.reserve(p_images.size());
+  f_frame_set->delays = p_delays;
+
+  for (int n_frame = 0 ; n_frame < p_images.size() ; ++n_frame)
+  {
+    QPixmap f_pixmap = QPixmap::fromImage(p_images.at(n_frame));
+
+    f_frame_set->byte_size += f_pixmap.width() * f_pixmap.height() * f_pixmap.depth() / 8;
+    f_frame_set->total_duration += p_delays.at(n_frame);
+    f_frame_set->frames.append(f_pixmap);
+  }
+
+  return f_frame_set;
+}
@@ -0,0 +1,142 @@
+#ifndef FRAMECACHE_H
+#define FRAMECACHE_H
+
+#include <QObject>
+#include <QString>
+#include <QSize>
+#include <QImage>
+#include <QPixmap>
+#include <QVector>
+#include <QCache>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+#include <QThreadPool>
+#include <QAtomicInt>
+#include <QSharedPointer>
+
+//every frame of an animation, decoded once and already in the size and format it's drawn in
+struct frame_set_type
+{
+  QVector<QPixmap> frames;
+  //in milliseconds, how long each frame stays up
+  QVector<int> delays;
+
+  int total_duration = 0;
+  int byte_size = 0;
+
+  //false for the stand-in get_first_frame() gives out while the rest is still being decoded
+  bool complete = true;
+};
+
+//how long each frame of an animation stays up, read without decoding any pixels
+struct animation_info_type
+{
+  int frame_count = 0;
+  //in milliseconds
+  QVector<int> delays;
+  int total_duration = 0;
+};
+
+class FrameDecodeTask;
+
+//decoded animations shared by every movie widget, keyed by file, size and orientation
+//the least recently used ones are dropped once the byte budget is used up. a widget holding on to a set
+//keeps it alive even after that
+//decoding happens on a pool of its own, only turning the images into pixmaps is left for the GUI thread
+class FrameCache : public QObject
+{
+  Q_OBJECT
+
+public:
+  FrameCache(int p_max_kilobytes, QObject *p_parent = nullptr);
+  ~FrameCache();
+
+  //returns null on a miss and starts decoding p_path, frames_ready() is emitted once that's done
+  //frames are decoded or scaled to p_size unless it's empty, then mirrored if p_flipped
+  //an unreadable file gives a set without frames, which isn't cached
+  //pixmaps can only be made on the GUI thread, so this can only be called from there
+  QSharedPointer<const frame_set_type> get_frames(QString p_path, QSize p_size, bool p_flipped);
+
+  //decodes just the first frame right away, for showing something until get_frames() has the rest
+  //the set isn't complete and isn't cached either
+  QSharedPointer<const frame_set_type> get_first_frame(QString p_path, QSize p_size, bool p_flipped);
+
+  //starts decoding p_path unless it's cached or on its way already. comes after anything get_frames() asked for
+  void prefetch(QString p_path, QSize p_size, bool p_flipped);
+
+  //frame count and delays of p_path, the same ones get_frames() would find. cached per file
+  animation_info_type get_info(QString p_path);
+
+  void set_max_kilobytes(int p_max_kilobytes);
+  void set_decode_threads(int p_threads);
+  //frames are scaled with smooth filtering from now on, fast filtering otherwise. drops what's cached
+  void set_smooth_scaling(bool p_smooth);
+  void clear();
+
+  void dump_stats();
+
+  //what frames_ready() is emitted with
+  static QString make_key(QString p_path, QSize p_size, bool p_flipped);
+
+signals:
+  //get_frames() has the set for p_key now, for as long as this is being emitted at the least
+  void frames_ready(QString p_key);
+
+private slots:
+  void on_decode_finished(QString p_key);
+
+private:
+  friend class FrameDecodeTask;
+
+  //what a decode task leaves behind for on_decode_finished()
+  struct decoded_type
+  {
+    QVector<QImage> images;
+    QVector<int> delays;
+  };
+
+  //QCache owns what it holds, this only hands out another reference to the set
+  struct cache_entry_type
+  {
+    QSharedPointer<const frame_set_type> frame_set;
+  };
+
+  //cost is in kilobytes, that keeps large budgets within an int
+  QCache<QString, cache_entry_type> m_sets;
+  QMutex m_mutex;
+
+  QHash<QString, animation_info_type> m_infos;
+
+  QThreadPool m_decode_pool;
+  //keys that are queued or being decoded, so that nothing is decoded twice at once
+  QSet<QString> m_pending;
+  QHash<QString, decoded_type> m_decoded;
+
+  //the set frames_ready() is about. it's handed out from here even if it was too big to cache
+  QString m_delivered_key;
+  QSharedPointer<const frame_set_type> m_delivered_set;
+
+  bool m_smooth = false;
+
+  QAtomicInt m_hits;
+  QAtomicInt m_misses;
+  QAtomicInt m_prefetches;
+  QAtomicInt m_decoded_kilobytes;
+
+  //expects m_mutex to be held
+  void queue_decode(QString p_key, QString p_path, QSize p_size, bool p_flipped, int p_priority);
+  void insert(QString p_key, QSharedPointer<const frame_set_type> p_frame_set);
+
+  //walks the blocks of a GIF and only looks at the graphic control extensions
+  static bool scan_gif(const uchar *p_data, qint64 p_size, animation_info_type &r_info);
+  static animation_info_type read_info(QString p_path);
+
+  //the part of decoding that doesn't need the GUI thread
+  static QImage prepare_frame(QImage p_image, QSize p_size, bool p_flipped, bool p_smooth);
+  static void decode(QString p_path, QSize p_size, bool p_flipped, bool p_smooth,
+                     QVector<QImage> &r_images, QVector<int> &r_delays);
+  static QSharedPointer<const frame_set_type> make_frame_set(const QVector<QImage> &p_images, const QVector<int> &p_delays);
+};
+
+#endif // FRAMECACHE_H
@@ -0,0 +1,42 @@
+#include "image_functions.h"
+
+void set_target_size(QImageReader &r_reader, QSize p_size)
+{
+  //the other readers that claim to support this decode at full size and then scale smoothly, whatever
+  //the quality profile says
+  if (!p_size.isEmpty() && r_reader.format() == "jpeg")
+    r_reader.setScaledSize(p_size);
+}
+
+QImage scale_image(QImage p_image, QSize p_size, bool p_smooth)
+{
+  if (p_image.isNull() || p_size.isEmpty() || p_image.size() == p_size)
+    return p_image;
+
+  if (!p_smooth)
+    return p_image.scaled(p_size, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+
+  //a smooth scale goes over every source pixel. when shrinking by more than half, skipping the surplus
+  //ones first costs next to nothing in quality
+  QSize f_halfway = p_size * 2;
+
+  if (p_image.width() > f_halfway.width() && p_image.height() > f_halfway.height())
+    p_image = p_image.scaled(f_halfway, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+
+  return p_image.scaled(p_size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+}
+
+QImage read_scaled_image(QString p_path, QSize p_size, bool p_smooth)
+{
+  QImageReader f_reader(p_path);
+  set_target_size(f_reader, p_size);
+
+  return scale_image(f_reader.read(), p_size, p_smooth);
+}
+
+QSize read_image_size(QString p_path)
+{
+  QImageReader f_reader(p_path);
+
+  return f_reader.size();
+}
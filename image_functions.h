@@ -0,0 +1,23 @@
+#ifndef IMAGE_FUNCTIONS_H
+#define IMAGE_FUNCTIONS_H
+
+#include <QImage>
+#include <QImageReader>
+#include <QSize>
+#include <QString>
+
+//images are read at the size they're drawn at. only the jpeg reader can decode at a lower resolution,
+//anything else goes through scale_image() right after decoding
+void set_target_size(QImageReader &r_reader, QSize p_size);
+
+//p_image at p_size, or as it is if p_size is empty. fast filtering is what the client always did,
+//smooth filtering is what the smooth quality profile asks for
+QImage scale_image(QImage p_image, QSize p_size, bool p_smooth);
+
+//the first image in p_path at p_size, null if there's nothing to read
+QImage read_scaled_image(QString p_path, QSize p_size, bool p_smooth);
+
+//the dimensions of p_path, read from the header
+QSize read_image_size(QString p_path);
+
+#endif // IMAGE_FUNCTIONS_H
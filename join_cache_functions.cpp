@@ -0,0 +1,58 @@
+#include "aoapplication.h"
+
+#include "courtroom.h"
+#include "joincache.h"
+
+bool AOApplication::load_join_cache()
+{
+  QString f_key = get_join_cache_key(current_server, char_list_size, evidence_list_size, music_list_size, server_list_hash);
+
+  join_cache_type f_lists;
+
+  if (!read_join_cache(get_join_cache_path(get_base_path(), f_key), f_key, f_lists))
+    return false;
+
+  if (f_lists.chars.size() != char_list_size || f_lists.music.size() != music_list_size)
+    return false;
+
+  //improved loading never asks for the evidence list, so a cache written that way has none
+  if (f_lists.evidence.size() != evidence_list_size && !(improved_loading_enabled && f_lists.evidence.isEmpty()))
+    return false;
+
+  for (char_type i_char : f_lists.chars)
+    w_courtroom->append_char(i_char);
+
+  for (evi_type i_evi : f_lists.evidence)
+    w_courtroom->append_evidence(i_evi);
+
+  for (QString i_song : f_lists.music)
+    w_courtroom->append_music(i_song);
+
+  loaded_chars = f_lists.chars.size();
+  loaded_evidence = f_lists.evidence.size();
+  loaded_music = f_lists.music.size();
+
+  return true;
+}
+
+void AOApplication::save_join_cache()
+{
+  if (!courtroom_constructed)
+    return;
+
+  join_cache_type f_lists;
+  f_lists.chars = w_courtroom->get_char_list();
+  f_lists.evidence = w_courtroom->get_evidence_list();
+  f_lists.music = w_courtroom->get_music_list();
+
+  //a list that didn't load completely would only be loaded incompletely again next time
+  if (f_lists.chars.size() != char_list_size || f_lists.music.size() != music_list_size)
+    return;
+
+  if (f_lists.evidence.size() != evidence_list_size && !(improved_loading_enabled && f_lists.evidence.isEmpty()))
+    return;
+
+  QString f_key = get_join_cache_key(current_server, char_list_size, evidence_list_size, music_list_size, server_list_hash);
+
+  write_join_cache(get_join_cache_path(get_base_path(), f_key), f_key, f_lists);
+}
@@ -0,0 +1,121 @@
+#include "joincache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDebug>
+
+//bump this whenever the layout below changes, older files are then simply ignored
+static const quint32 join_cache_magic = 0x414F4A43;
+static const quint32 join_cache_version = 1;
+
+QString get_join_cache_key(server_type p_server, int p_chars, int p_evidence, int p_music, QString p_hash)
+{
+  return p_server.ip + ":" + QString::number(p_server.port) + "#" + QString::number(p_chars) + "#" +
+         QString::number(p_evidence) + "#" + QString::number(p_music) + "#" + p_hash;
+}
+
+QString get_join_cache_path(QString p_base_path, QString p_key)
+{
+  QByteArray f_digest = QCryptographicHash::hash(p_key.toUtf8(), QCryptographicHash::Sha1).toHex();
+
+  return p_base_path + "cache/" + QString::fromLatin1(f_digest) + ".joincache";
+}
+
+bool read_join_cache(QString p_path, QString p_key, join_cache_type &r_lists)
+{
+  QFile f_file(p_path);
+  if (!f_file.open(QIODevice::ReadOnly))
+    return false;
+
+  QDataStream in(&f_file);
+  in.setVersion(QDataStream::Qt_5_0);
+
+  quint32 f_magic, f_version;
+  QString f_stored_key;
+
+  in >> f_magic >> f_version;
+
+  if (f_magic != join_cache_magic || f_version != join_cache_version)
+    return false;
+
+  in >> f_stored_key;
+
+  if (f_stored_key != p_key)
+    return false;
+
+  join_cache_type f_lists;
+  qint32 f_char_count, f_evidence_count, f_music_count;
+
+  in >> f_char_count;
+
+  for (int n_char = 0 ; n_char < f_char_count && in.status() == QDataStream::Ok ; ++n_char)
+  {
+    char_type f_char;
+    in >> f_char.name >> f_char.description >> f_char.evidence_string;
+    //temporary. the CharsCheck packet sets this properly
+    f_char.taken = false;
+    f_lists.chars.append(f_char);
+  }
+
+  in >> f_evidence_count;
+
+  for (int n_evi = 0 ; n_evi < f_evidence_count && in.status() == QDataStream::Ok ; ++n_evi)
+  {
+    evi_type f_evi;
+    in >> f_evi.name >> f_evi.description >> f_evi.image;
+    f_lists.evidence.append(f_evi);
+  }
+
+  in >> f_music_count;
+
+  for (int n_song = 0 ; n_song < f_music_count && in.status() == QDataStream::Ok ; ++n_song)
+  {
+    QString f_song;
+    in >> f_song;
+    f_lists.music.append(f_song);
+  }
+
+  if (in.status() != QDataStream::Ok)
+  {
+    qDebug() << "W: join cache" << p_path << "is truncated or corrupt";
+    return false;
+  }
+
+  r_lists = f_lists;
+
+  return true;
+}
+
+bool write_join_cache(QString p_path, QString p_key, const join_cache_type &p_lists)
+{
+  QDir().mkpath(QFileInfo(p_path).absolutePath());
+
+  QSaveFile f_file(p_path);
+  if (!f_file.open(QIODevice::WriteOnly))
+  {
+    qDebug() << "W: could not write join cache" << p_path;
+    return false;
+  }
+
+  QDataStream out(&f_file);
+  out.setVersion(QDataStream::Qt_5_0);
+
+  out << join_cache_magic << join_cache_version << p_key;
+
+  out << static_cast<qint32>(p_lists.chars.size());
+  for (char_type i_char : p_lists.chars)
+    out << i_char.name << i_char.description << i_char.evidence_string;
+
+  out << static_cast<qint32>(p_lists.evidence.size());
+  for (evi_type i_evi : p_lists.evidence)
+    out << i_evi.name << i_evi.description << i_evi.image;
+
+  out << static_cast<qint32>(p_lists.music.size());
+  for (QString i_song : p_lists.music)
+    out << i_song;
+
+  return f_file.commit();
+}
@@ -0,0 +1,26 @@
+#ifndef JOINCACHE_H
+#define JOINCACHE_H
+
+#include "datatypes.h"
+
+#include <QString>
+#include <QVector>
+
+//the lists a server sends on join, the way they are kept between joins
+struct join_cache_type
+{
+  QVector<char_type> chars;
+  QVector<evi_type> evidence;
+  QVector<QString> music;
+};
+
+//the lists of a server are considered unchanged as long as the address, the SI sizes and the
+//advertised digest (if any) are
+QString get_join_cache_key(server_type p_server, int p_chars, int p_evidence, int p_music, QString p_hash);
+QString get_join_cache_path(QString p_base_path, QString p_key);
+
+//returns false if there is no cache for p_key at p_path or it can't be read. the list sizes are not checked
+bool read_join_cache(QString p_path, QString p_key, join_cache_type &r_lists);
+bool write_join_cache(QString p_path, QString p_key, const join_cache_type &p_lists);
+
+#endif // JOINCACHE_H
@@ -310,6 +310,7 @@ void Lobby::on_server_list_clicked(QModelIndex p_model)
 
   ui_player_count->setText("Offline");
 
+  ao_app->current_server = f_server;
   ao_app->net_manager->connect_to_server(f_server);
 }
 
@@ -0,0 +1,117 @@
+//mkpack <base folder> <output.aopack> [folder ...]
+//packs the given folders of base/ (characters, background and sounds by default) into one file the client
+//maps at startup. an .aopack is a binary Qt resource: an index followed by the file data, every entry
+//compressed (zlib, or zstd if a newer rcc was built with it) only if that actually saves something. entries are stored under their path relative
+//to base/, lowercased, which is how the client looks them up
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QLibraryInfo>
+#include <QProcess>
+#include <QTemporaryFile>
+#include <QXmlStreamWriter>
+
+#include <cstdio>
+
+//in percent. gifs, pngs and mp3s barely compress, wavs do
+static const int compression_threshold = 10;
+
+static int write_qrc(QString p_base, QStringList p_folders, QIODevice *p_device)
+{
+  QDir f_base(p_base);
+  int f_files = 0;
+
+  QXmlStreamWriter f_xml(p_device);
+  f_xml.setAutoFormatting(true);
+
+  f_xml.writeStartDocument();
+  f_xml.writeStartElement("RCC");
+  f_xml.writeStartElement("qresource");
+  f_xml.writeAttribute("prefix", "/");
+
+  for (QString i_folder : p_folders)
+  {
+    QDirIterator f_it(f_base.filePath(i_folder), QDir::Files | QDir::Hidden, QDirIterator::Subdirectories);
+
+    while (f_it.hasNext())
+    {
+      QString f_path = f_it.next();
+
+      f_xml.writeStartElement("file");
+      f_xml.writeAttribute("alias", f_base.relativeFilePath(f_path).toLower());
+      f_xml.writeCharacters(QFileInfo(f_path).absoluteFilePath());
+      f_xml.writeEndElement();
+
+      ++f_files;
+    }
+  }
+
+  f_xml.writeEndElement();
+  f_xml.writeEndElement();
+  f_xml.writeEndDocument();
+
+  return f_files;
+}
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication app(argc, argv);
+
+  QStringList f_args = app.arguments();
+
+  if (f_args.size() < 3)
+  {
+    fprintf(stderr, "usage: mkpack <base folder> <output.aopack> [folder ...]\n");
+    return 1;
+  }
+
+  QString f_base = f_args.at(1);
+  QString f_output = f_args.at(2);
+  QStringList f_folders = f_args.mid(3);
+
+  if (f_folders.isEmpty())
+    f_folders << "characters" << "background" << "sounds";
+
+  if (!QFileInfo(f_base).isDir())
+  {
+    fprintf(stderr, "mkpack: %s is not a folder\n", qPrintable(f_base));
+    return 1;
+  }
+
+  QTemporaryFile f_qrc(QDir::tempPath() + "/mkpack-XXXXXX.qrc");
+
+  if (!f_qrc.open())
+  {
+    fprintf(stderr, "mkpack: could not create a temporary file\n");
+    return 1;
+  }
+
+  int f_files = write_qrc(f_base, f_folders, &f_qrc);
+  f_qrc.close();
+
+  if (f_files == 0)
+  {
+    fprintf(stderr, "mkpack: nothing to pack\n");
+    return 1;
+  }
+
+  QString f_rcc = QLibraryInfo::location(QLibraryInfo::BinariesPath) + "/rcc";
+
+  QProcess f_process;
+  f_process.setProcessChannelMode(QProcess::ForwardedChannels);
+  f_process.start(f_rcc, QStringList() << "-binary" << "-compress" << "9"
+                                       << "-threshold" << QString::number(compression_threshold)
+                                       << f_qrc.fileName() << "-o" << f_output);
+
+  if (!f_process.waitForFinished(-1) || f_process.exitStatus() != QProcess::NormalExit || f_process.exitCode() != 0)
+  {
+    fprintf(stderr, "mkpack: %s failed\n", qPrintable(f_rcc));
+    return 1;
+  }
+
+  printf("packed %d files into %s\n", f_files, qPrintable(f_output));
+
+  return 0;
+}
@@ -0,0 +1,16 @@
+#-------------------------------------------------
+#
+# packs folders of base/ into an .aopack the client maps at startup
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TARGET = mkpack
+TEMPLATE = app
+
+SOURCES += main.cpp
@@ -5,85 +5,178 @@
 #include "lobby.h"
 
 
-NetworkManager::NetworkManager(AOApplication *parent) : QObject(parent)
+//has no parent so it can be moved to the network thread
+NetworkManager::NetworkManager(AOApplication *p_ao_app) : QObject()
 {
-  ao_app = parent;
+  ao_app = p_ao_app;
 
   ms_socket = new QTcpSocket(this);
   server_socket = new QTcpSocket(this);
 
+  ms_dns = nullptr;
+
+  ms_racer = new ConnectionRacer(this);
+  ms_racer->set_stagger(stagger_milliseconds);
+  ms_racer->set_timeout(timeout_milliseconds);
+
+  QObject::connect(ms_racer, SIGNAL(finished(QTcpSocket*)), this, SLOT(on_ms_race_finished(QTcpSocket*)));
   QObject::connect(ms_socket, SIGNAL(readyRead()), this, SLOT(handle_ms_packet()));
   QObject::connect(server_socket, SIGNAL(readyRead()), this, SLOT(handle_server_packet()));
+  QObject::connect(server_socket, SIGNAL(connected()), this, SLOT(on_server_connected()));
   QObject::connect(server_socket, SIGNAL(disconnected()), ao_app, SLOT(server_disconnected()));
 }
 
+//runs on the network thread as that finishes, see AOApplication's destructor
 NetworkManager::~NetworkManager()
 {
+  AOPacket *f_packet;
+
+  while (ms_inbox.dequeue(f_packet))
+    delete f_packet;
 
+  inbound_packet_type f_inbound;
+
+  while (server_inbox.dequeue(f_inbound))
+    delete f_inbound.packet;
 }
 
 void NetworkManager::connect_to_master()
 {
-  ms_socket->close();
-  ms_socket->abort();
-
-  perform_srv_lookup();
+  QMetaObject::invokeMethod(this, "start_master_connect", Qt::QueuedConnection);
 }
 
 void NetworkManager::connect_to_server(server_type p_server)
 {
-  server_socket->close();
-  server_socket->abort();
+  //from here on the GUI thread ignores whatever the old connection still delivers
+  int f_generation = server_generation.fetchAndAddOrdered(1) + 1;
 
-  server_socket->connectToHost(p_server.ip, p_server.port);
+  QMetaObject::invokeMethod(this, "start_server_connect", Qt::QueuedConnection,
+                            Q_ARG(QString, p_server.ip), Q_ARG(int, p_server.port), Q_ARG(int, f_generation));
 }
 
 void NetworkManager::ship_ms_packet(QString p_packet)
 {
-  ms_socket->write(p_packet.toUtf8());
+  ms_outbox.enqueue(p_packet);
 }
 
 void NetworkManager::ship_server_packet(QString p_packet)
 {
-  server_socket->write(p_packet.toUtf8());
+  server_outbox.enqueue(p_packet);
 }
 
-void NetworkManager::handle_ms_packet()
+void NetworkManager::request_flush()
 {
-  char buffer[16384] = {0};
-  ms_socket->read(buffer, ms_socket->bytesAvailable());
+  if (outbox_flush_scheduled.testAndSetOrdered(0, 1))
+    QMetaObject::invokeMethod(this, "flush_outbox", Qt::QueuedConnection);
+}
 
-  QString in_data = buffer;
+void NetworkManager::flush_outbox()
+{
+  //cleared first, so a flush requested while this one runs is queued again instead of being lost
+  outbox_flush_scheduled.storeRelease(0);
 
-  if (!in_data.endsWith("%"))
-  {
-    ms_partial_packet = true;
-    ms_temp_packet += in_data;
-    return;
-  }
+  write_batch(ms_socket, ms_outbox);
+  write_batch(server_socket, server_outbox);
+}
 
-  else
+//everything queued for a socket is joined into a single write
+void NetworkManager::write_batch(QTcpSocket *p_socket, SpscQueue<QString> &p_outbox)
+{
+  QByteArray f_batch;
+  QString f_packet;
+  int f_packets = 0;
+
+  while (p_outbox.dequeue(f_packet))
   {
-    if (ms_partial_packet)
-    {
-      in_data = ms_temp_packet + in_data;
-      ms_temp_packet = "";
-      ms_partial_packet = false;
-    }
+    f_batch.append(f_packet.toUtf8());
+    ++f_packets;
   }
 
-  QStringList packet_list = in_data.split("%", QString::SplitBehavior(QString::SkipEmptyParts));
+  if (f_packets == 0)
+    return;
+
+  p_socket->write(f_batch);
+
+  packets_shipped.fetchAndAddRelaxed(f_packets);
+  socket_writes.fetchAndAddRelaxed(1);
+  bytes_written.fetchAndAddRelaxed(f_batch.size());
+}
+
+void NetworkManager::on_server_connected()
+{
+  //the option only sticks once the socket is actually open
+  if (low_delay_enabled)
+    server_socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+}
+
+//all of the parsing happens here, the GUI thread only gets to read the fields
+AOPacket *NetworkManager::make_inbound_packet(const QByteArray &p_frame)
+{
+  //the size has to be passed along, the QByteArray overload stops at the first NUL
+  AOPacket *f_packet = new AOPacket(QString::fromUtf8(p_frame.constData(), p_frame.size()));
+  f_packet->net_decode();
+  f_packet->get_contents();
+
+  return f_packet;
+}
+
+void NetworkManager::schedule_inbox_drain()
+{
+  if (inbox_drain_scheduled.testAndSetOrdered(0, 1))
+    QMetaObject::invokeMethod(ao_app, "drain_inbox", Qt::QueuedConnection);
+}
+
+void NetworkManager::start_master_connect()
+{
+  ms_socket->close();
+  ms_socket->abort();
+  ms_framer.clear();
+
+  ms_racer->cancel();
 
-  for (QString packet : packet_list)
-  {    
-    AOPacket *f_packet = new AOPacket(packet);
+  perform_srv_lookup();
+}
 
-    ao_app->ms_packet_received(f_packet);
+void NetworkManager::start_server_connect(QString p_ip, int p_port, int p_generation)
+{
+  server_socket->close();
+  server_socket->abort();
+  server_framer.clear();
+
+  current_server_generation = p_generation;
+
+  //whatever was meant for the old server stays with it
+  QString f_stale;
+
+  while (server_outbox.dequeue(f_stale))
+    ;
+
+  server_socket->connectToHost(p_ip, p_port);
+}
+
+void NetworkManager::handle_ms_packet()
+{
+  ms_framer.append(ms_socket->readAll());
+
+  QByteArray f_frame;
+
+  while (ms_framer.next_frame(f_frame))
+  {
+    ms_inbox.enqueue(make_inbound_packet(f_frame));
+    schedule_inbox_drain();
   }
 }
 
 void NetworkManager::perform_srv_lookup()
 {
+  if (ms_dns != nullptr)
+  {
+    //a lookup from an earlier connect attempt is still running, its result is of no use anymore
+    ms_dns->disconnect(this);
+    ms_dns->abort();
+    ms_dns->deleteLater();
+  }
+
   ms_dns = new QDnsLookup(QDnsLookup::SRV, ms_hostname, this);
 
   connect(ms_dns, SIGNAL(finished()), this, SLOT(on_srv_lookup()));
@@ -92,83 +185,64 @@ void NetworkManager::perform_srv_lookup()
 
 void NetworkManager::on_srv_lookup()
 {
-  bool connected = false;
+  ms_dns->deleteLater();
+
   if (ms_dns->error() != QDnsLookup::NoError)
   {
     qWarning("SRV lookup of the master server DNS failed.");
-    ms_dns->deleteLater();
-  }
-  else
-  {
-    const auto srv_records = ms_dns->serviceRecords();
-
-    for (const QDnsServiceRecord &record : srv_records)
-    {
-      qDebug() << "Connecting to " << record.target() << ":" << record.port();
-      ms_socket->connectToHost(record.target(), record.port());
-      QTime timer;
-      timer.start();
-      do
-      {
-        ao_app->processEvents();
-        if (ms_socket->state() == QAbstractSocket::ConnectedState)
-        {
-          connected = true;
-          break;
-        }
-        else if (ms_socket->state() != QAbstractSocket::ConnectingState
-                 && ms_socket->state() != QAbstractSocket::HostLookupState
-                 && ms_socket->error() != -1)
-        {
-          qDebug() << ms_socket->error();
-          qWarning() << "Error connecting to master server:" << ms_socket->errorString();
-          ms_socket->abort();
-          ms_socket->close();
-          break;
-        }
-      } while (timer.elapsed() < timeout_milliseconds); // Very expensive spin-wait loop - it will bring CPU to 100%!
-      if (connected) break;
-      else
-      {
-        ms_socket->abort();
-        ms_socket->close();
-      }
-    }
+    ms_dns = nullptr;
+    on_ms_race_finished(nullptr);
+    return;
   }
-  emit ms_connect_finished(connected);
-}
 
-void NetworkManager::handle_server_packet()
-{
-  char buffer[16384] = {0};
-  server_socket->read(buffer, server_socket->bytesAvailable());
+  QVector<QPair<QString, quint16>> f_targets;
+
+  for (QDnsServiceRecord i_record : ms_dns->serviceRecords())
+    f_targets.append(qMakePair(i_record.target(), i_record.port()));
 
-  QString in_data = buffer;
+  ms_dns = nullptr;
 
-  if (!in_data.endsWith("%"))
+  if (f_targets.isEmpty())
   {
-    partial_packet = true;
-    temp_packet += in_data;
+    qWarning("SRV lookup of the master server DNS returned no records.");
+    on_ms_race_finished(nullptr);
     return;
   }
 
-  else
+  ms_racer->start(f_targets);
+}
+
+void NetworkManager::on_ms_race_finished(QTcpSocket *p_socket)
+{
+  if (p_socket != nullptr)
   {
-    if (partial_packet)
-    {
-      in_data = temp_packet + in_data;
-      temp_packet = "";
-      partial_packet = false;
-    }
+    p_socket->setParent(this);
+
+    ms_socket->disconnect(this);
+    ms_socket->deleteLater();
+
+    ms_socket = p_socket;
+    ms_framer.clear();
+
+    QObject::connect(ms_socket, SIGNAL(readyRead()), this, SLOT(handle_ms_packet()));
   }
 
-  QStringList packet_list = in_data.split("%", QString::SplitBehavior(QString::SkipEmptyParts));
+  emit ms_connect_finished(p_socket != nullptr);
+}
 
-  for (QString packet : packet_list)
+void NetworkManager::handle_server_packet()
+{
+  server_framer.append(server_socket->readAll());
+
+  QByteArray f_frame;
+
+  while (server_framer.next_frame(f_frame))
   {
-    AOPacket *f_packet = new AOPacket(packet);
+    inbound_packet_type f_inbound;
+    f_inbound.packet = make_inbound_packet(f_frame);
+    f_inbound.generation = current_server_generation;
 
-    ao_app->server_packet_received(f_packet);
+    server_inbox.enqueue(f_inbound);
+    schedule_inbox_drain();
   }
 }
-
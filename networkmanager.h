@@ -3,17 +3,30 @@
 
 #include "aopacket.h"
 #include "aoapplication.h"
+#include "packetframer.h"
+#include "spscqueue.h"
+#include "connectionracer.h"
 
 #include <QTcpSocket>
 #include <QDnsLookup>
-#include <QTime>
+#include <QVector>
+#include <QAtomicInt>
 
+//a packet from the game server along with the connection it came in on
+struct inbound_packet_type
+{
+  AOPacket *packet = nullptr;
+  int generation = 0;
+};
+
+//lives on its own thread, see AOApplication's constructor. everything in here runs on that thread
+//except for the functions marked as callable from the GUI thread
 class NetworkManager : public QObject
 {
   Q_OBJECT
 
 public:
-  NetworkManager(AOApplication *parent);
+  NetworkManager(AOApplication *p_ao_app);
   ~NetworkManager();
 
   AOApplication *ao_app;
@@ -23,31 +36,72 @@ public:
 
   QString ms_hostname = "_aoms._tcp.aceattorneyonline.com";
   int ms_port = 27016;
+  //how long the last started SRV target gets before the connect is given up
   const int timeout_milliseconds = 2000;
+  //head start each SRV target gets before the next one is tried alongside it
+  const int stagger_milliseconds = 250;
 
-  bool ms_partial_packet = false;
-  QString ms_temp_packet = "";
-
-  bool partial_packet = false;
-  QString temp_packet = "";
+  PacketFramer ms_framer;
+  PacketFramer server_framer;
 
   unsigned int s_decryptor = 5;
 
+  //received packets that are already framed and decoded, AOApplication drains these on the GUI thread
+  SpscQueue<AOPacket*> ms_inbox;
+  SpscQueue<inbound_packet_type> server_inbox;
+  //set while a drain is queued on the GUI thread, so a burst of packets only queues one
+  QAtomicInt inbox_drain_scheduled;
+
+  //sets TCP_NODELAY on the server socket. written before the network thread starts
+  bool low_delay_enabled = false;
+
+  //outbound totals, read by AOApplication::dump_packet_stats
+  QAtomicInt packets_shipped;
+  QAtomicInt socket_writes;
+  QAtomicInt bytes_written;
+
+  //bumped by every connect_to_server(). packets in server_inbox that carry an older one are from a
+  //connection that has been replaced and have to be dropped
+  QAtomicInt server_generation;
+
+  //callable from the GUI thread
   void connect_to_master();
   void connect_to_server(server_type p_server);
-
-public slots:
+  //these only queue the packet, it goes out with the next request_flush()
   void ship_ms_packet(QString p_packet);
   void ship_server_packet(QString p_packet);
+  void request_flush();
 
 signals:
   void ms_connect_finished(bool success);
 
 private:
+  //filled by the GUI thread, written out by flush_outbox()
+  SpscQueue<QString> ms_outbox;
+  SpscQueue<QString> server_outbox;
+  QAtomicInt outbox_flush_scheduled;
+
+  //what the packets read from server_socket are tagged with, only touched by the network thread
+  int current_server_generation = 0;
+
+  void write_batch(QTcpSocket *p_socket, SpscQueue<QString> &p_outbox);
+  AOPacket *make_inbound_packet(const QByteArray &p_frame);
+  void schedule_inbox_drain();
+
+  //races the SRV targets of the master server against each other
+  ConnectionRacer *ms_racer;
+
   void perform_srv_lookup();
 
 private slots:
+  void start_master_connect();
+  void start_server_connect(QString p_ip, int p_port, int p_generation);
+  void flush_outbox();
+  void on_server_connected();
+
   void on_srv_lookup();
+  //p_socket is the target that connected, or nullptr if every target failed
+  void on_ms_race_finished(QTcpSocket *p_socket);
   void handle_ms_packet();
   void handle_server_packet();
 };
@@ -8,16 +8,57 @@
 #include "debug_functions.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
 
-void AOApplication::ms_packet_received(AOPacket *p_packet)
+#include <algorithm>
+
+void AOApplication::drain_inbox()
+{
+  //cleared before draining, a packet that comes in from here on queues another drain
+  net_manager->inbox_drain_scheduled.storeRelease(0);
+
+  AOPacket *f_packet;
+  int f_drained = 0;
+
+  while (f_drained < max_packets_per_drain && net_manager->ms_inbox.dequeue(f_packet))
+  {
+    ms_packet_received(f_packet);
+    ++f_drained;
+  }
+
+  inbound_packet_type f_inbound;
+  int f_generation = net_manager->server_generation.loadAcquire();
+
+  while (f_drained < max_packets_per_drain && net_manager->server_inbox.dequeue(f_inbound))
+  {
+    //left over from a server we have connected away from since
+    if (f_inbound.generation != f_generation)
+    {
+      delete f_inbound.packet;
+      continue;
+    }
+
+    server_packet_received(f_inbound.packet);
+    ++f_drained;
+  }
+
+  //there may be more waiting, come back once the event loop has had its turn
+  if (f_drained == max_packets_per_drain && net_manager->inbox_drain_scheduled.testAndSetOrdered(0, 1))
+    QMetaObject::invokeMethod(this, "drain_inbox", Qt::QueuedConnection);
+}
+
+void AOApplication::flush_outbox()
 {
-  p_packet->net_decode();
+  net_manager->request_flush();
+}
 
+void AOApplication::ms_packet_received(AOPacket *p_packet)
+{
   QString header = p_packet->get_header();
   QStringList f_contents = p_packet->get_contents();
 
   if (header != "CHECK")
-    qDebug() << "R(ms):" << p_packet->to_string();
+    qDebug() << "R(ms):" << p_packet->get_raw_string();
 
   if (header == "ALL")
   {
@@ -121,467 +162,678 @@ void AOApplication::ms_packet_received(AOPacket *p_packet)
   delete p_packet;
 }
 
-void AOApplication::server_packet_received(AOPacket *p_packet)
+void AOApplication::register_server_packet_handlers()
 {
-  p_packet->net_decode();
+  server_packet_handlers.insert("decryptor", {&AOApplication::handle_decryptor_packet});
+  server_packet_handlers.insert("ID", {&AOApplication::handle_id_packet});
+  server_packet_handlers.insert("CT", {&AOApplication::handle_ct_packet});
+  server_packet_handlers.insert("FL", {&AOApplication::handle_fl_packet});
+  server_packet_handlers.insert("PN", {&AOApplication::handle_pn_packet});
+  server_packet_handlers.insert("SI", {&AOApplication::handle_si_packet});
+  server_packet_handlers.insert("CI", {&AOApplication::handle_ci_packet});
+  server_packet_handlers.insert("EI", {&AOApplication::handle_ei_packet});
+  server_packet_handlers.insert("EM", {&AOApplication::handle_em_packet});
+  server_packet_handlers.insert("CharsCheck", {&AOApplication::handle_charscheck_packet});
+  server_packet_handlers.insert("SC", {&AOApplication::handle_sc_packet});
+  server_packet_handlers.insert("SM", {&AOApplication::handle_sm_packet});
+  server_packet_handlers.insert("DONE", {&AOApplication::handle_done_packet});
+  server_packet_handlers.insert("BN", {&AOApplication::handle_bn_packet});
+  //server accepting char request(CC) packet
+  server_packet_handlers.insert("PV", {&AOApplication::handle_pv_packet});
+  server_packet_handlers.insert("MS", {&AOApplication::handle_ms_packet});
+  server_packet_handlers.insert("confirm", {&AOApplication::handle_confirm_packet});
+  server_packet_handlers.insert("MC", {&AOApplication::handle_mc_packet});
+  server_packet_handlers.insert("RT", {&AOApplication::handle_rt_packet});
+  server_packet_handlers.insert("HP", {&AOApplication::handle_hp_packet});
+  server_packet_handlers.insert("LE", {&AOApplication::handle_le_packet});
+  server_packet_handlers.insert("IL", {&AOApplication::handle_il_packet});
+  server_packet_handlers.insert("MU", {&AOApplication::handle_mu_packet});
+  server_packet_handlers.insert("UM", {&AOApplication::handle_um_packet});
+  server_packet_handlers.insert("KK", {&AOApplication::handle_kk_packet});
+  server_packet_handlers.insert("KB", {&AOApplication::handle_kb_packet});
+  server_packet_handlers.insert("BD", {&AOApplication::handle_bd_packet});
+  server_packet_handlers.insert("ZZ", {&AOApplication::handle_zz_packet});
+}
 
+void AOApplication::server_packet_received(AOPacket *p_packet)
+{
   QString header = p_packet->get_header();
-  QStringList f_contents = p_packet->get_contents();
-  QString f_packet = p_packet->to_string();
 
   if (header != "checkconnection")
-    qDebug() << "R:" << f_packet;
+    qDebug() << "R:" << p_packet->get_raw_string();
 
-  if (header == "decryptor")
+  //the table is never modified after startup, so this iterator survives nested event loops inside a handler
+  QHash<QString, packet_handler_type>::iterator f_handler = server_packet_handlers.find(header);
+
+  if (f_handler != server_packet_handlers.end())
   {
-    if (f_contents.size() == 0)
-      goto end;
+    QElapsedTimer f_timer;
+    f_timer.start();
 
-    //you may ask where 322 comes from. that would be a good question.
-    s_decryptor = fanta_decrypt(f_contents.at(0), 322).toUInt();
+    (this->*(f_handler->handler))(p_packet);
 
-    //default(legacy) values
-    encryption_needed = true;
-    yellow_text_enabled = false;
-    prezoom_enabled = false;
-    flipping_enabled = false;
-    custom_objection_enabled = false;
-    improved_loading_enabled = false;
-    desk_mod_enabled = false;
-    evidence_enabled = false;
+    qint64 f_elapsed = f_timer.nsecsElapsed();
+
+    ++f_handler->count;
+    f_handler->total_nsecs += f_elapsed;
+    if (f_elapsed > f_handler->max_nsecs)
+      f_handler->max_nsecs = f_elapsed;
+  }
 
-    //workaround for tsuserver4
-    if (f_contents.at(0) == "NOENCRYPT")
-      encryption_needed = false;
+  delete p_packet;
+}
 
-    QString f_hdid;
-    f_hdid = get_hdid();
+void AOApplication::dump_packet_stats()
+{
+  QStringList f_headers = server_packet_handlers.keys();
 
-    AOPacket *hi_packet = new AOPacket("HI#" + f_hdid + "#%");
-    send_server_packet(hi_packet);
-  }
-  else if (header == "ID")
+  //most expensive packet types first
+  std::sort(f_headers.begin(), f_headers.end(), [this](const QString &a, const QString &b)
   {
-    if (f_contents.size() < 2)
-      goto end;
+    return server_packet_handlers.value(a).total_nsecs > server_packet_handlers.value(b).total_nsecs;
+  });
 
-    s_pv = f_contents.at(0).toInt();
-    server_software = f_contents.at(1);
+  qDebug() << "packet stats (header, count, total us, avg us, max us):";
 
-    send_server_packet(new AOPacket("ID#AO2#" + get_version_string() + "#%"));
-  }
-  else if (header == "CT")
+  for (QString i_header : f_headers)
   {
-    if (f_contents.size() < 2)
-      goto end;
+    packet_handler_type f_handler = server_packet_handlers.value(i_header);
+
+    if (f_handler.count == 0)
+      continue;
 
-    if (courtroom_constructed)
-      w_courtroom->append_server_chatmessage(f_contents.at(0), f_contents.at(1));
+    qDebug() << i_header << f_handler.count << f_handler.total_nsecs / 1000
+             << f_handler.total_nsecs / f_handler.count / 1000 << f_handler.max_nsecs / 1000;
   }
-  else if (header == "FL")
+
+  int f_packets = net_manager->packets_shipped.loadAcquire();
+  int f_writes = net_manager->socket_writes.loadAcquire();
+  int f_bytes = net_manager->bytes_written.loadAcquire();
+
+  if (f_writes > 0)
   {
-    if (f_packet.contains("yellowtext",Qt::CaseInsensitive))
-      yellow_text_enabled = true;
-    if (f_packet.contains("flipping",Qt::CaseInsensitive))
-      flipping_enabled = true;
-    if (f_packet.contains("customobjections",Qt::CaseInsensitive))
-      custom_objection_enabled = true;
-    if (f_packet.contains("fastloading",Qt::CaseInsensitive))
-      improved_loading_enabled = true;
-    if (f_packet.contains("noencryption",Qt::CaseInsensitive))
-      encryption_needed = false;
-    if (f_packet.contains("deskmod",Qt::CaseInsensitive))
-      desk_mod_enabled = true;
-    if (f_packet.contains("evidence",Qt::CaseInsensitive))
-      evidence_enabled = true;
+    qDebug() << "outbound stats (packets, writes, packets per write, bytes per write):"
+             << f_packets << f_writes << double(f_packets) / f_writes << f_bytes / f_writes;
   }
-  else if (header == "PN")
-  {
-    if (f_contents.size() < 2)
-      goto end;
+}
 
-    w_lobby->set_player_count(f_contents.at(0).toInt(), f_contents.at(1).toInt());
-  }
-  else if (header == "SI")
-  {
-    if (f_contents.size() != 3)
-      goto end;
+void AOApplication::handle_decryptor_packet(AOPacket *p_packet)
+{
+  if (p_packet->get_field_count() == 0)
+    return;
+
+  //you may ask where 322 comes from. that would be a good question.
+  s_decryptor = fanta_decrypt(p_packet->get_field(0), 322).toUInt();
+
+  //default(legacy) values
+  encryption_needed = true;
+  yellow_text_enabled = false;
+  prezoom_enabled = false;
+  flipping_enabled = false;
+  custom_objection_enabled = false;
+  improved_loading_enabled = false;
+  desk_mod_enabled = false;
+  evidence_enabled = false;
+  server_list_hash = "";
+
+  //workaround for tsuserver4
+  if (p_packet->get_field(0) == "NOENCRYPT")
+    encryption_needed = false;
+
+  QString f_hdid;
+  f_hdid = get_hdid();
+
+  AOPacket *hi_packet = new AOPacket("HI#" + f_hdid + "#%");
+  send_server_packet(hi_packet);
+}
 
-    char_list_size = f_contents.at(0).toInt();
-    evidence_list_size = f_contents.at(1).toInt();
-    music_list_size = f_contents.at(2).toInt();
+void AOApplication::handle_id_packet(AOPacket *p_packet)
+{
+  if (p_packet->get_field_count() < 2)
+    return;
 
-    if (char_list_size < 1 || evidence_list_size < 0 || music_list_size < 0)
-      goto end;
+  s_pv = p_packet->get_field(0).toInt();
+  server_software = p_packet->get_field(1);
 
-    loaded_chars = 0;
-    loaded_evidence = 0;
-    loaded_music = 0;
+  send_server_packet(new AOPacket("ID#AO2#" + get_version_string() + "#%"));
+}
 
-    destruct_courtroom();
-    construct_courtroom();
+void AOApplication::handle_ct_packet(AOPacket *p_packet)
+{
+  if (p_packet->get_field_count() < 2)
+    return;
 
-    courtroom_loaded = false;
+  if (courtroom_constructed)
+    w_courtroom->append_server_chatmessage(p_packet->get_field(0), p_packet->get_field(1));
+}
 
-    QString window_title = "Attorney Online 2";
-    int selected_server = w_lobby->get_selected_server();
+void AOApplication::handle_fl_packet(AOPacket *p_packet)
+{
+  QString f_packet = p_packet->get_raw_string();
+
+  if (f_packet.contains("yellowtext",Qt::CaseInsensitive))
+    yellow_text_enabled = true;
+  if (f_packet.contains("flipping",Qt::CaseInsensitive))
+    flipping_enabled = true;
+  if (f_packet.contains("customobjections",Qt::CaseInsensitive))
+    custom_objection_enabled = true;
+  if (f_packet.contains("fastloading",Qt::CaseInsensitive))
+    improved_loading_enabled = true;
+  if (f_packet.contains("noencryption",Qt::CaseInsensitive))
+    encryption_needed = false;
+  if (f_packet.contains("deskmod",Qt::CaseInsensitive))
+    desk_mod_enabled = true;
+  if (f_packet.contains("evidence",Qt::CaseInsensitive))
+    evidence_enabled = true;
+
+  for (int n_field = 0 ; n_field < p_packet->get_field_count() ; ++n_field)
+  {
+    QString f_field = p_packet->get_field(n_field);
+
+    if (f_field.startsWith("hash=", Qt::CaseInsensitive))
+      server_list_hash = f_field.mid(5);
+  }
+}
 
-    if (w_lobby->public_servers_selected)
-    {
-      if (selected_server >= 0 && selected_server < server_list.size())
-        window_title += ": " + server_list.at(selected_server).name;
-    }
-    else
-    {
-      if (selected_server >= 0 && selected_server < favorite_list.size())
-        window_title += ": " + favorite_list.at(selected_server).name;
-    }
+void AOApplication::handle_pn_packet(AOPacket *p_packet)
+{
+  if (p_packet->get_field_count() < 2)
+    return;
 
-    w_courtroom->set_window_title(window_title);
+  w_lobby->set_player_count(p_packet->get_field(0).toInt(), p_packet->get_field(1).toInt());
+}
 
-    w_lobby->show_loading_overlay();
-    w_lobby->set_loading_text("Loading");
-    w_lobby->set_loading_value(0);
+void AOApplication::handle_si_packet(AOPacket *p_packet)
+{
+  if (p_packet->get_field_count() != 3)
+    return;
 
-    AOPacket *f_packet;
+  char_list_size = p_packet->get_field(0).toInt();
+  evidence_list_size = p_packet->get_field(1).toInt();
+  music_list_size = p_packet->get_field(2).toInt();
 
-    if(improved_loading_enabled)
-      f_packet = new AOPacket("RC#%");
-    else
-      f_packet = new AOPacket("askchar2#%");
+  if (char_list_size < 1 || evidence_list_size < 0 || music_list_size < 0)
+    return;
 
-    send_server_packet(f_packet);
-  }
-  else if (header == "CI")
-  {
-    if (!courtroom_constructed)
-      goto end;
+  loaded_chars = 0;
+  loaded_evidence = 0;
+  loaded_music = 0;
 
-    for (int n_element = 0 ; n_element < f_contents.size() ; n_element += 2)
-    {
-      if (f_contents.at(n_element).toInt() != loaded_chars)
-        break;
+  loading_window = get_loading_window();
+  legacy_next_request = 1;
+  legacy_responses_received = 0;
+  pending_char_pages.clear();
+  pending_evidence.clear();
+  pending_music_pages.clear();
 
-      //this means we are on the last element and checking n + 1 element will be game over so
-      if (n_element == f_contents.size() - 1)
-        break;
+  destruct_courtroom();
+  construct_courtroom();
 
-      QStringList sub_elements = f_contents.at(n_element + 1).split("&");
-      if (sub_elements.size() < 2)
-        break;
+  courtroom_loaded = false;
 
-      char_type f_char;
-      f_char.name = sub_elements.at(0);
-      f_char.description = sub_elements.at(1);
-      f_char.evidence_string = sub_elements.at(3);
-      //temporary. the CharsCheck packet sets this properly
-      f_char.taken = false;
+  QString window_title = "Attorney Online 2";
+  int selected_server = w_lobby->get_selected_server();
+
+  if (w_lobby->public_servers_selected)
+  {
+    if (selected_server >= 0 && selected_server < server_list.size())
+      window_title += ": " + server_list.at(selected_server).name;
+  }
+  else
+  {
+    if (selected_server >= 0 && selected_server < favorite_list.size())
+      window_title += ": " + favorite_list.at(selected_server).name;
+  }
 
-      ++loaded_chars;
+  w_courtroom->set_window_title(window_title);
 
-      w_lobby->set_loading_text("Loading chars:\n" + QString::number(loaded_chars) + "/" + QString::number(char_list_size));
+  w_lobby->show_loading_overlay();
+  w_lobby->set_loading_text("Loading");
+  w_lobby->set_loading_value(0);
 
-      w_courtroom->append_char(f_char);
-    }
+  join_cache_hit = load_join_cache();
 
-    int total_loading_size = char_list_size + evidence_list_size + music_list_size;
-    int loading_value = (loaded_chars / static_cast<double>(total_loading_size)) * 100;
-    w_lobby->set_loading_value(loading_value);
+  if (join_cache_hit)
+  {
+    w_lobby->set_loading_value(100);
 
+    //the lists are already there, so ask for what comes last in the handshake. the server answers that with DONE
     if (improved_loading_enabled)
-      send_server_packet(new AOPacket("RE#%"));
+      send_server_packet(new AOPacket("RD#%"));
     else
-    {
-      QString next_packet_number = QString::number(((loaded_chars - 1) / 10) + 1);
-      send_server_packet(new AOPacket("AN#" + next_packet_number + "#%"));
-    }
+      send_server_packet(new AOPacket("AM#" + QString::number((music_list_size - 1) / 10 + 1) + "#%"));
 
+    return;
   }
-  else if (header == "EI")
-  {
-    if (!courtroom_constructed)
-      goto end;
-
 
-    // +1 because evidence starts at 1 rather than 0 for whatever reason
-    //enjoy fanta
-    if (f_contents.at(0).toInt() != loaded_evidence + 1)
-      goto end;
+  AOPacket *f_packet;
 
-    if (f_contents.size() < 2)
-      goto end;
+  if(improved_loading_enabled)
+    f_packet = new AOPacket("RC#%");
+  else
+    f_packet = new AOPacket("askchar2#%");
 
-    QStringList sub_elements = f_contents.at(1).split("&");
-    if (sub_elements.size() < 4)
-      goto end;
+  send_server_packet(f_packet);
+}
 
-    evi_type f_evi;
-    f_evi.name = sub_elements.at(0);
-    f_evi.description = sub_elements.at(1);
-    //no idea what the number at position 2 is. probably an identifier?
-    f_evi.image = sub_elements.at(3);
+void AOApplication::handle_ci_packet(AOPacket *p_packet)
+{
+  if (!courtroom_constructed || p_packet->get_field_count() < 1)
+    return;
 
-    ++loaded_evidence;
+  if (improved_loading_enabled)
+  {
+    append_char_page(p_packet->get_contents());
+    send_server_packet(new AOPacket("RE#%"));
+    return;
+  }
 
-    w_lobby->set_loading_text("Loading evidence:\n" + QString::number(loaded_evidence) + "/" + QString::number(evidence_list_size));
+  ++legacy_responses_received;
+  pending_char_pages.insert(p_packet->get_field(0).toInt(), p_packet->get_contents());
 
-    w_courtroom->append_evidence(f_evi);
+  //pages are applied strictly in order, one that doesn't start at loaded_chars waits for the ones before it
+  while (!pending_char_pages.isEmpty() && pending_char_pages.firstKey() <= loaded_chars)
+  {
+    int f_first = pending_char_pages.firstKey();
+    QStringList f_page = pending_char_pages.take(f_first);
 
-    int total_loading_size = char_list_size + evidence_list_size + music_list_size;
-    int loading_value = ((loaded_chars + loaded_evidence) / static_cast<double>(total_loading_size)) * 100;
-    w_lobby->set_loading_value(loading_value);
+    if (f_first == loaded_chars)
+      append_char_page(f_page);
+  }
 
-    QString next_packet_number = QString::number(loaded_evidence);
-    send_server_packet(new AOPacket("AE#" + next_packet_number + "#%"));
+  send_legacy_loading_requests();
+}
 
-  }
-  else if (header == "EM")
+void AOApplication::append_char_page(const QStringList &p_fields)
+{
+  for (int n_element = 0 ; n_element < p_fields.size() ; n_element += 2)
   {
-    if (!courtroom_constructed)
-      goto end;
+    if (p_fields.at(n_element).toInt() != loaded_chars)
+      break;
 
-    for (int n_element = 0 ; n_element < f_contents.size() ; n_element += 2)
-    {
-      if (f_contents.at(n_element).toInt() != loaded_music)
-        break;
+    //this means we are on the last element and checking n + 1 element will be game over so
+    if (n_element == p_fields.size() - 1)
+      break;
 
-      if (n_element == f_contents.size() - 1)
-        break;
+    QStringList sub_elements = p_fields.at(n_element + 1).split("&");
+    if (sub_elements.size() < 2)
+      break;
 
-      QString f_music = f_contents.at(n_element + 1);
+    char_type f_char;
+    f_char.name = sub_elements.at(0);
+    f_char.description = sub_elements.at(1);
+    f_char.evidence_string = sub_elements.value(3);
+    //temporary. the CharsCheck packet sets this properly
+    f_char.taken = false;
 
-      ++loaded_music;
+    ++loaded_chars;
 
-      w_lobby->set_loading_text("Loading music:\n" + QString::number(loaded_music) + "/" + QString::number(music_list_size));
+    w_lobby->set_loading_text("Loading chars:\n" + QString::number(loaded_chars) + "/" + QString::number(char_list_size));
 
-      w_courtroom->append_music(f_music);
-    }
+    w_courtroom->append_char(f_char);
+  }
 
-    int total_loading_size = char_list_size + evidence_list_size + music_list_size;
-    int loading_value = ((loaded_chars + loaded_evidence + loaded_music) / static_cast<double>(total_loading_size)) * 100;
-    w_lobby->set_loading_value(loading_value);
+  int total_loading_size = char_list_size + evidence_list_size + music_list_size;
+  int loading_value = (loaded_chars / static_cast<double>(total_loading_size)) * 100;
+  w_lobby->set_loading_value(loading_value);
+}
 
-    QString next_packet_number = QString::number(((loaded_music - 1) / 10) + 1);
-    send_server_packet(new AOPacket("AM#" + next_packet_number + "#%"));
-  }
-  else if (header == "CharsCheck")
+void AOApplication::handle_ei_packet(AOPacket *p_packet)
+{
+  if (!courtroom_constructed || p_packet->get_field_count() < 1)
+    return;
+
+  ++legacy_responses_received;
+  pending_evidence.insert(p_packet->get_field(0).toInt(), p_packet->get_contents());
+
+  // +1 because evidence starts at 1 rather than 0 for whatever reason
+  //enjoy fanta
+  while (!pending_evidence.isEmpty() && pending_evidence.firstKey() <= loaded_evidence + 1)
   {
-    if (!courtroom_constructed)
-      goto end;
+    int f_index = pending_evidence.firstKey();
+    QStringList f_evidence = pending_evidence.take(f_index);
 
-    for (int n_char = 0 ; n_char < f_contents.size() ; ++n_char)
-    {
-      if (f_contents.at(n_char) == "-1")
-        w_courtroom->set_taken(n_char, true);
-      else
-        w_courtroom->set_taken(n_char, false);
-    }
+    if (f_index == loaded_evidence + 1)
+      append_evidence(f_evidence);
   }
 
-  else if (header == "SC")
-  {
-    if (!courtroom_constructed)
-      goto end;
+  send_legacy_loading_requests();
+}
 
-    for (int n_element = 0 ; n_element < f_contents.size() ; ++n_element)
-    {
-      QStringList sub_elements = f_contents.at(n_element).split("&");
+void AOApplication::append_evidence(const QStringList &p_fields)
+{
+  if (p_fields.size() < 2)
+    return;
 
-      char_type f_char;
-      f_char.name = sub_elements.at(0);
-      if (sub_elements.size() >= 2)
-        f_char.description = sub_elements.at(1);
+  QStringList sub_elements = p_fields.at(1).split("&");
+  if (sub_elements.size() < 4)
+    return;
 
-      //temporary. the CharsCheck packet sets this properly
-      f_char.taken = false;
+  evi_type f_evi;
+  f_evi.name = sub_elements.at(0);
+  f_evi.description = sub_elements.at(1);
+  //no idea what the number at position 2 is. probably an identifier?
+  f_evi.image = sub_elements.at(3);
 
-      ++loaded_chars;
+  ++loaded_evidence;
 
-      w_lobby->set_loading_text("Loading chars:\n" + QString::number(loaded_chars) + "/" + QString::number(char_list_size));
+  w_lobby->set_loading_text("Loading evidence:\n" + QString::number(loaded_evidence) + "/" + QString::number(evidence_list_size));
 
-      w_courtroom->append_char(f_char);
-    }
+  w_courtroom->append_evidence(f_evi);
+
+  int total_loading_size = char_list_size + evidence_list_size + music_list_size;
+  int loading_value = ((loaded_chars + loaded_evidence) / static_cast<double>(total_loading_size)) * 100;
+  w_lobby->set_loading_value(loading_value);
+}
+
+void AOApplication::handle_em_packet(AOPacket *p_packet)
+{
+  if (!courtroom_constructed || p_packet->get_field_count() < 1)
+    return;
 
-    int total_loading_size = char_list_size + evidence_list_size + music_list_size;
-    int loading_value = (loaded_chars / static_cast<double>(total_loading_size)) * 100;
-    w_lobby->set_loading_value(loading_value);
+  ++legacy_responses_received;
+  pending_music_pages.insert(p_packet->get_field(0).toInt(), p_packet->get_contents());
 
-    send_server_packet(new AOPacket("RM#%"));
+  while (!pending_music_pages.isEmpty() && pending_music_pages.firstKey() <= loaded_music)
+  {
+    int f_first = pending_music_pages.firstKey();
+    QStringList f_page = pending_music_pages.take(f_first);
+
+    if (f_first == loaded_music)
+      append_music_page(f_page);
   }
-  else if (header == "SM")
+
+  send_legacy_loading_requests();
+}
+
+void AOApplication::append_music_page(const QStringList &p_fields)
+{
+  for (int n_element = 0 ; n_element < p_fields.size() ; n_element += 2)
   {
-    if (!courtroom_constructed)
-      goto end;
+    if (p_fields.at(n_element).toInt() != loaded_music)
+      break;
 
-    for (int n_element = 0 ; n_element < f_contents.size() ; ++n_element)
-    {
-      ++loaded_music;
+    if (n_element == p_fields.size() - 1)
+      break;
 
-      w_lobby->set_loading_text("Loading music:\n" + QString::number(loaded_music) + "/" + QString::number(music_list_size));
+    QString f_music = p_fields.at(n_element + 1);
 
-      w_courtroom->append_music(f_contents.at(n_element));
-    }
+    ++loaded_music;
 
-    int total_loading_size = char_list_size + evidence_list_size + music_list_size;
-    int loading_value = (loaded_chars / static_cast<double>(total_loading_size)) * 100;
-    w_lobby->set_loading_value(loading_value);
+    w_lobby->set_loading_text("Loading music:\n" + QString::number(loaded_music) + "/" + QString::number(music_list_size));
 
-    send_server_packet(new AOPacket("RD#%"));
+    w_courtroom->append_music(f_music);
   }
-  else if (header == "DONE")
-  {
-    if (!courtroom_constructed)
-      goto end;
 
-    if (lobby_constructed)
-      w_courtroom->append_ms_chatmessage("", w_lobby->get_chatlog());
+  int total_loading_size = char_list_size + evidence_list_size + music_list_size;
+  int loading_value = ((loaded_chars + loaded_evidence + loaded_music) / static_cast<double>(total_loading_size)) * 100;
+  w_lobby->set_loading_value(loading_value);
+}
 
-    w_courtroom->done_received();
+//the legacy handshake is one fixed sequence: AN#1..AN#n for the character pages, AE#1..AE#n for the evidence
+//and AM#1..AM#n for the music pages. the server answers every request with exactly one CI, EI or EM packet,
+//except for the last one of each list which moves on to the next list (or to DONE) instead.
+//askchar2 counts as the first request, its answer is character page 0
+void AOApplication::send_legacy_loading_requests()
+{
+  int f_char_pages = (char_list_size - 1) / 10 + 1;
+  int f_evidence = evidence_list_size;
+  int f_music_pages = (music_list_size - 1) / 10 + 1;
 
-    courtroom_loaded = true;
+  int f_last_request = f_char_pages + f_evidence + f_music_pages;
 
-    destruct_lobby();
-  }
-  else if (header == "BN")
+  while (legacy_next_request <= f_last_request && legacy_next_request - legacy_responses_received < loading_window)
   {
-    if (f_contents.size() < 1)
-      goto end;
+    int f_request = legacy_next_request++;
 
-    if (courtroom_constructed)
-      w_courtroom->set_background(f_contents.at(0));
+    if (f_request <= f_char_pages)
+      send_server_packet(new AOPacket("AN#" + QString::number(f_request) + "#%"));
+    else if (f_request <= f_char_pages + f_evidence)
+      send_server_packet(new AOPacket("AE#" + QString::number(f_request - f_char_pages) + "#%"));
+    else
+      send_server_packet(new AOPacket("AM#" + QString::number(f_request - f_char_pages - f_evidence) + "#%"));
   }
-  //server accepting char request(CC) packet
-  else if (header == "PV")
-  {
-    if (f_contents.size() < 3)
-      goto end;
+}
 
-    if (courtroom_constructed)
-      w_courtroom->enter_courtroom(f_contents.at(2).toInt());
-  }
-  else if (header == "MS")
+void AOApplication::handle_charscheck_packet(AOPacket *p_packet)
+{
+  if (!courtroom_constructed)
+    return;
+
+  for (int n_char = 0 ; n_char < p_packet->get_field_count() ; ++n_char)
   {
-    if (courtroom_constructed && courtroom_loaded)
-      w_courtroom->handle_chatmessage(&p_packet->get_contents());
+    if (p_packet->get_field(n_char) == "-1")
+      w_courtroom->set_taken(n_char, true);
+    else
+      w_courtroom->set_taken(n_char, false);
   }
-  else if (header == "confirm") {
-      if (!w_courtroom) {
-          goto end;
-      }
+}
 
-      auto s = p_packet->get_contents();
-      if (s.length() < 1) {
-          qDebug() << "Not enough arguments for confirm.";
-          goto end;
-      }
+void AOApplication::handle_sc_packet(AOPacket *p_packet)
+{
+  if (!courtroom_constructed)
+    return;
 
-      bool o;
-      auto t = s[0].toInt(&o);
+  for (int n_element = 0 ; n_element < p_packet->get_field_count() ; ++n_element)
+  {
+    QStringList sub_elements = p_packet->get_field(n_element).split("&");
 
-      if (!o) {
-          goto end;
-      }
+    char_type f_char;
+    f_char.name = sub_elements.at(0);
+    if (sub_elements.size() >= 2)
+      f_char.description = sub_elements.at(1);
 
-      switch (t) {
-          case 0:
-          w_courtroom->cc();
-          break;
+    //temporary. the CharsCheck packet sets this properly
+    f_char.taken = false;
 
-          case 1:
-          w_courtroom->cd();
-          break;
-      }
-  }
-  else if (header == "MC")
-  {
-    if (courtroom_constructed && courtroom_loaded)
-      w_courtroom->handle_song(&p_packet->get_contents());
-  }
-  else if (header == "RT")
-  {
-    if (f_contents.size() < 1)
-      goto end;
-    if (courtroom_constructed)
-      w_courtroom->handle_wtce(f_contents.at(0));
+    ++loaded_chars;
+
+    w_lobby->set_loading_text("Loading chars:\n" + QString::number(loaded_chars) + "/" + QString::number(char_list_size));
+
+    w_courtroom->append_char(f_char);
   }
-  else if (header == "HP")
+
+  int total_loading_size = char_list_size + evidence_list_size + music_list_size;
+  int loading_value = (loaded_chars / static_cast<double>(total_loading_size)) * 100;
+  w_lobby->set_loading_value(loading_value);
+
+  send_server_packet(new AOPacket("RM#%"));
+}
+
+void AOApplication::handle_sm_packet(AOPacket *p_packet)
+{
+  if (!courtroom_constructed)
+    return;
+
+  for (int n_element = 0 ; n_element < p_packet->get_field_count() ; ++n_element)
   {
-    if (courtroom_constructed && f_contents.size() > 1)
-      w_courtroom->set_hp_bar(f_contents.at(0).toInt(), f_contents.at(1).toInt());
+    ++loaded_music;
+
+    w_lobby->set_loading_text("Loading music:\n" + QString::number(loaded_music) + "/" + QString::number(music_list_size));
+
+    w_courtroom->append_music(p_packet->get_field(n_element));
   }
-  else if (header == "LE")
-  {
-    if (courtroom_constructed)
-    {
-      QVector<evi_type> f_evi_list;
 
-      for (QString f_string : f_contents)
-      {
-        QStringList sub_contents = f_string.split("&");
+  int total_loading_size = char_list_size + evidence_list_size + music_list_size;
+  int loading_value = (loaded_chars / static_cast<double>(total_loading_size)) * 100;
+  w_lobby->set_loading_value(loading_value);
+
+  send_server_packet(new AOPacket("RD#%"));
+}
+
+void AOApplication::handle_done_packet(AOPacket *p_packet)
+{
+  Q_UNUSED(p_packet);
 
-        if (sub_contents.size() < 3)
-          continue;
+  if (!courtroom_constructed)
+    return;
 
-        evi_type f_evi;
-        f_evi.name = sub_contents.at(0);
-        f_evi.description = sub_contents.at(1);
-        f_evi.image = sub_contents.at(2);
+  if (lobby_constructed)
+    w_courtroom->append_ms_chatmessage("", w_lobby->get_chatlog());
 
-        f_evi_list.append(f_evi);
-      }
+  w_courtroom->done_received();
+
+  courtroom_loaded = true;
+
+  prefetch_char_profiles(w_courtroom->get_char_list());
+
+  if (!join_cache_hit)
+    save_join_cache();
+
+  destruct_lobby();
+}
+
+void AOApplication::handle_bn_packet(AOPacket *p_packet)
+{
+  if (p_packet->get_field_count() < 1)
+    return;
+
+  if (courtroom_constructed)
+    w_courtroom->set_background(p_packet->get_field(0));
+}
+
+void AOApplication::handle_pv_packet(AOPacket *p_packet)
+{
+  if (p_packet->get_field_count() < 3)
+    return;
+
+  if (courtroom_constructed)
+    w_courtroom->enter_courtroom(p_packet->get_field(2).toInt());
+}
+
+void AOApplication::handle_ms_packet(AOPacket *p_packet)
+{
+  note_speaker(p_packet->get_field(CHAR_NAME));
+
+  if (courtroom_constructed && courtroom_loaded)
+    w_courtroom->handle_chatmessage(p_packet);
+}
 
-      w_courtroom->set_evidence_list(f_evi_list);
+void AOApplication::handle_confirm_packet(AOPacket *p_packet)
+{
+    if (!w_courtroom) {
+        return;
     }
-  }
-  else if (header == "IL")
-  {
-    if (courtroom_constructed && f_contents.size() > 0)
-      w_courtroom->set_ip_list(f_contents.at(0));
-  }
-  else if (header == "MU")
-  {
-    if (courtroom_constructed && f_contents.size() > 0)
-      w_courtroom->set_mute(true, f_contents.at(0).toInt());
-  }
-  else if (header == "UM")
-  {
-    if (courtroom_constructed && f_contents.size() > 0)
-      w_courtroom->set_mute(false, f_contents.at(0).toInt());
-  }
-  else if (header == "KK")
+
+    if (p_packet->get_field_count() < 1) {
+        qDebug() << "Not enough arguments for confirm.";
+        return;
+    }
+
+    bool o;
+    auto t = p_packet->get_field(0).toInt(&o);
+
+    if (!o) {
+        return;
+    }
+
+    switch (t) {
+        case 0:
+        w_courtroom->cc();
+        break;
+
+        case 1:
+        w_courtroom->cd();
+        break;
+    }
+}
+
+void AOApplication::handle_mc_packet(AOPacket *p_packet)
+{
+  if (courtroom_constructed && courtroom_loaded)
+    w_courtroom->handle_song(&p_packet->get_contents());
+}
+
+void AOApplication::handle_rt_packet(AOPacket *p_packet)
+{
+  if (p_packet->get_field_count() < 1)
+    return;
+  if (courtroom_constructed)
+    w_courtroom->handle_wtce(p_packet->get_field(0));
+}
+
+void AOApplication::handle_hp_packet(AOPacket *p_packet)
+{
+  if (courtroom_constructed && p_packet->get_field_count() > 1)
+    w_courtroom->set_hp_bar(p_packet->get_field(0).toInt(), p_packet->get_field(1).toInt());
+}
+
+void AOApplication::handle_le_packet(AOPacket *p_packet)
+{
+  if (courtroom_constructed)
   {
-    if (courtroom_constructed && f_contents.size() > 0)
+    QVector<evi_type> f_evi_list;
+
+    for (int n_element = 0 ; n_element < p_packet->get_field_count() ; ++n_element)
     {
-      int f_cid = w_courtroom->get_cid();
-      int remote_cid = f_contents.at(0).toInt();
+      QStringList sub_contents = p_packet->get_field(n_element).split("&");
 
-      if (f_cid != remote_cid && remote_cid != -1)
-        goto end;
+      if (sub_contents.size() < 3)
+        continue;
+
+      evi_type f_evi;
+      f_evi.name = sub_contents.at(0);
+      f_evi.description = sub_contents.at(1);
+      f_evi.image = sub_contents.at(2);
 
-      call_notice("You have been kicked.");
-      construct_lobby();
-      destruct_courtroom();
+      f_evi_list.append(f_evi);
     }
 
+    w_courtroom->set_evidence_list(f_evi_list);
   }
-  else if (header == "KB")
-  {
-    if (courtroom_constructed && f_contents.size() > 0)
-      w_courtroom->set_ban(f_contents.at(0).toInt());
-  }
-  else if (header == "BD")
-  {
-    call_notice("You are banned on this server.");
-  }
-  else if (header == "ZZ")
+}
+
+void AOApplication::handle_il_packet(AOPacket *p_packet)
+{
+  if (courtroom_constructed && p_packet->get_field_count() > 0)
+    w_courtroom->set_ip_list(p_packet->get_field(0));
+}
+
+void AOApplication::handle_mu_packet(AOPacket *p_packet)
+{
+  if (courtroom_constructed && p_packet->get_field_count() > 0)
+    w_courtroom->set_mute(true, p_packet->get_field(0).toInt());
+}
+
+void AOApplication::handle_um_packet(AOPacket *p_packet)
+{
+  if (courtroom_constructed && p_packet->get_field_count() > 0)
+    w_courtroom->set_mute(false, p_packet->get_field(0).toInt());
+}
+
+void AOApplication::handle_kk_packet(AOPacket *p_packet)
+{
+  if (courtroom_constructed && p_packet->get_field_count() > 0)
   {
-    if (courtroom_constructed && f_contents.size() > 0)
-      w_courtroom->mod_called(f_contents.at(0));
+    int f_cid = w_courtroom->get_cid();
+    int remote_cid = p_packet->get_field(0).toInt();
+
+    if (f_cid != remote_cid && remote_cid != -1)
+      return;
+
+    call_notice("You have been kicked.");
+    construct_lobby();
+    destruct_courtroom();
   }
+}
 
-  end:
+void AOApplication::handle_kb_packet(AOPacket *p_packet)
+{
+  if (courtroom_constructed && p_packet->get_field_count() > 0)
+    w_courtroom->set_ban(p_packet->get_field(0).toInt());
+}
 
-  delete p_packet;
+void AOApplication::handle_bd_packet(AOPacket *p_packet)
+{
+  Q_UNUSED(p_packet);
+
+  call_notice("You are banned on this server.");
+}
+
+void AOApplication::handle_zz_packet(AOPacket *p_packet)
+{
+  if (courtroom_constructed && p_packet->get_field_count() > 0)
+    w_courtroom->mod_called(p_packet->get_field(0));
 }
 
 void AOApplication::send_ms_packet(AOPacket *p_packet)
@@ -592,6 +844,9 @@ void AOApplication::send_ms_packet(AOPacket *p_packet)
 
   net_manager->ship_ms_packet(f_packet);
 
+  if (!outbox_flush_timer->isActive())
+    outbox_flush_timer->start();
+
   qDebug() << "S(ms):" << f_packet;
 
   delete p_packet;
@@ -604,6 +859,9 @@ void AOApplication::send_server_packet(AOPacket *p_packet, bool encoded)
 
   QString f_packet = p_packet->to_string();
 
+  //chat is what people notice lag on, so with tcp_nodelay it doesn't wait for the rest of the turn
+  bool f_urgent = p_packet->get_header() == "MS";
+
   if (encryption_needed)
   {
     qDebug() << "S(e):" << f_packet;
@@ -618,5 +876,13 @@ void AOApplication::send_server_packet(AOPacket *p_packet, bool encoded)
 
   net_manager->ship_server_packet(f_packet);
 
+  if (f_urgent && net_manager->low_delay_enabled)
+  {
+    outbox_flush_timer->stop();
+    net_manager->request_flush();
+  }
+  else if (!outbox_flush_timer->isActive())
+    outbox_flush_timer->start();
+
   delete p_packet;
 }
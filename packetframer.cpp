@@ -0,0 +1,59 @@
+#include "packetframer.h"
+
+#include <cstring>
+
+PacketFramer::PacketFramer()
+{
+
+}
+
+void PacketFramer::append(const QByteArray &p_data)
+{
+  //drop whatever was consumed already. what remains is at most one partial packet
+  if (m_read_pos > 0)
+  {
+    m_buffer.remove(0, m_read_pos);
+    m_scan_pos -= m_read_pos;
+    m_read_pos = 0;
+  }
+
+  m_buffer.append(p_data);
+}
+
+bool PacketFramer::next_frame(QByteArray &r_frame)
+{
+  const char *f_data = m_buffer.constData();
+
+  while (m_scan_pos < m_buffer.size())
+  {
+    const void *f_delimiter = memchr(f_data + m_scan_pos, '%', m_buffer.size() - m_scan_pos);
+
+    if (f_delimiter == nullptr)
+    {
+      m_scan_pos = m_buffer.size();
+      return false;
+    }
+
+    int f_start = m_read_pos;
+    int f_end = static_cast<const char*>(f_delimiter) - f_data;
+
+    m_read_pos = f_end + 1;
+    m_scan_pos = f_end + 1;
+
+    //"%%" and the like carry nothing, the old split() skipped them as well
+    if (f_end == f_start)
+      continue;
+
+    r_frame = QByteArray::fromRawData(f_data + f_start, f_end - f_start);
+    return true;
+  }
+
+  return false;
+}
+
+void PacketFramer::clear()
+{
+  m_buffer.clear();
+  m_read_pos = 0;
+  m_scan_pos = 0;
+}
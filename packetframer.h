@@ -0,0 +1,31 @@
+#ifndef PACKETFRAMER_H
+#define PACKETFRAMER_H
+
+#include <QByteArray>
+
+//collects raw socket bytes and cuts them into %-terminated frames
+//only the bytes that arrived since the last call are searched for a delimiter,
+//so a packet split over many reads is never rescanned from the start
+class PacketFramer
+{
+public:
+  PacketFramer();
+
+  void append(const QByteArray &p_data);
+
+  //returns false if no complete frame is buffered yet
+  //r_frame does not own its data, it stays valid until the next append() or clear()
+  bool next_frame(QByteArray &r_frame);
+
+  void clear();
+
+private:
+  QByteArray m_buffer;
+
+  //first byte that has not been handed out as part of a frame
+  int m_read_pos = 0;
+  //every byte before this position has already been searched for a delimiter
+  int m_scan_pos = 0;
+};
+
+#endif // PACKETFRAMER_H
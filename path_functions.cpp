@@ -53,7 +53,7 @@ QString AOApplication::get_data_path()
 
 QString AOApplication::get_theme_path()
 {
-  return get_base_path() + "themes/" + user_theme.toLower() + "/";
+  return resolve_path(get_base_path() + "themes/" + user_theme + "/");
 }
 
 QString AOApplication::get_default_theme_path()
@@ -63,16 +63,16 @@ QString AOApplication::get_default_theme_path()
 
 QString AOApplication::get_character_path(QString p_character)
 {
-  return get_base_path() + "characters/" + p_character.toLower() + "/";
+  return resolve_path(get_base_path() + "characters/" + p_character + "/");
 }
 
 QString AOApplication::get_demothings_path()
 {
   QString default_path = "misc/demothings/";
   QString alt_path = "misc/RosterImages";
-  if (dir_exists(default_path))
+  if (dir_exists(get_base_path() + default_path))
     return get_base_path() + default_path;
-  else if (dir_exists(alt_path))
+  else if (dir_exists(get_base_path() + alt_path))
     return get_base_path() + alt_path;
   else
     return get_base_path() + default_path;
@@ -83,7 +83,7 @@ QString AOApplication::get_sounds_path()
 }
 QString AOApplication::get_music_path(QString p_song)
 {
-  return get_base_path() + "sounds/music/" + p_song.toLower();
+  return resolve_path(get_base_path() + "sounds/music/" + p_song);
 }
 
 QString AOApplication::get_background_path()
@@ -103,9 +103,9 @@ QString AOApplication::get_evidence_path()
 {
     QString default_path = "evidence/";
     QString alt_path = "items/";
-    if (dir_exists(default_path))
+    if (dir_exists(get_base_path() + default_path))
       return get_base_path() + default_path;
-    else if (dir_exists(alt_path))
+    else if (dir_exists(get_base_path() + alt_path))
       return get_base_path() + alt_path;
     else
       return get_base_path() + default_path;
@@ -113,7 +113,7 @@ QString AOApplication::get_evidence_path()
 
 QString Courtroom::get_background_path()
 {
-  return ao_app->get_base_path() + "background/" + current_background.toLower() + "/";
+  return resolve_path(ao_app->get_base_path() + "background/" + current_background + "/");
 }
 
 QString Courtroom::get_default_background_path()
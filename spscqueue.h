@@ -0,0 +1,102 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <QAtomicPointer>
+
+//unbounded single producer, single consumer queue that needs no lock
+//exactly one thread may call enqueue() and exactly one (other) thread may call dequeue()
+//the consumer always holds a stub node whose value has already been taken, so the two ends never touch the same node
+//nodes the consumer is done with are handed back to the producer, so once the queue has been as long as it
+//gets, enqueue() stops allocating
+template <typename T>
+class SpscQueue
+{
+public:
+  SpscQueue()
+  {
+    node *f_stub = new node;
+
+    m_head.store(f_stub);
+    m_tail = f_stub;
+    m_first = f_stub;
+    m_head_copy = f_stub;
+  }
+
+  ~SpscQueue()
+  {
+    //every node there is, recycled or not, hangs off m_first
+    while (m_first != nullptr)
+    {
+      node *f_next = m_first->next.load();
+      delete m_first;
+      m_first = f_next;
+    }
+  }
+
+  //producer side
+  void enqueue(const T &p_value)
+  {
+    node *f_node = get_node();
+    f_node->value = p_value;
+
+    //publishes the value along with the node
+    m_tail->next.storeRelease(f_node);
+    m_tail = f_node;
+  }
+
+  //consumer side, returns false if the queue is empty
+  bool dequeue(T &r_value)
+  {
+    node *f_head = m_head.load();
+    node *f_next = f_head->next.loadAcquire();
+
+    if (f_next == nullptr)
+      return false;
+
+    r_value = f_next->value;
+    f_next->value = T();
+
+    //everything before f_next belongs to the producer again from here on
+    m_head.storeRelease(f_next);
+
+    return true;
+  }
+
+private:
+  struct node
+  {
+    node() : value(), next(nullptr) {}
+
+    T value;
+    QAtomicPointer<node> next;
+  };
+
+  Q_DISABLE_COPY(SpscQueue)
+
+  //producer side. the nodes from m_first up to the consumer's stub have been dequeued and can be reused
+  node *get_node()
+  {
+    if (m_first == m_head_copy)
+      m_head_copy = m_head.loadAcquire();
+
+    if (m_first != m_head_copy)
+    {
+      node *f_node = m_first;
+      m_first = m_first->next.load();
+      f_node->next.store(nullptr);
+      return f_node;
+    }
+
+    return new node;
+  }
+
+  //the consumer's stub, written by the consumer and read by the producer
+  QAtomicPointer<node> m_head;
+
+  //only touched by the producer
+  node *m_tail;
+  node *m_first;
+  node *m_head_copy;
+};
+
+#endif // SPSCQUEUE_H
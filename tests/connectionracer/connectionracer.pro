@@ -0,0 +1,21 @@
+#-------------------------------------------------
+#
+# races the master server connect against local listeners that accept, refuse or never answer
+#
+#-------------------------------------------------
+
+QT       += core network testlib
+QT       -= gui
+
+CONFIG   += console c++11 testcase
+CONFIG   -= app_bundle
+
+TARGET = tst_connectionracer
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../..
+
+SOURCES += tst_connectionracer.cpp \
+    $$PWD/../../connectionracer.cpp
+
+HEADERS += $$PWD/../../connectionracer.h
@@ -0,0 +1,220 @@
+#include "connectionracer.h"
+
+#include <QtTest>
+#include <QTcpServer>
+#include <QSignalSpy>
+#include <QElapsedTimer>
+
+typedef QPair<QString, quint16> target_type;
+
+//short enough to keep the run quick, far enough apart to tell a hand over from a head start running out
+static const int stagger_milliseconds = 200;
+static const int timeout_milliseconds = 1000;
+
+//a connect that is never answered, the way a firewall that drops packets leaves it
+class HangingSocket : public QTcpSocket
+{
+public:
+  HangingSocket(QObject *parent) : QTcpSocket(parent) {}
+
+  using QTcpSocket::connectToHost;
+
+  void connectToHost(const QString &p_host, quint16 p_port, OpenMode p_mode, NetworkLayerProtocol p_protocol) override
+  {
+    Q_UNUSED(p_host);
+    Q_UNUSED(p_port);
+    Q_UNUSED(p_mode);
+    Q_UNUSED(p_protocol);
+  }
+};
+
+//hands out a HangingSocket for the ports in hanging_ports and real sockets for everything else
+class StandInRacer : public ConnectionRacer
+{
+public:
+  QSet<quint16> hanging_ports;
+
+protected:
+  QTcpSocket *create_socket(QString p_host, quint16 p_port) override
+  {
+    if (hanging_ports.contains(p_port))
+      return new HangingSocket(this);
+
+    return ConnectionRacer::create_socket(p_host, p_port);
+  }
+};
+
+class tst_ConnectionRacer : public QObject
+{
+  Q_OBJECT
+
+private:
+  QTcpServer accepting_server;
+  QTcpServer second_server;
+
+  target_type accepting_target();
+  target_type refusing_target();
+  //a port nothing listens on, so a socket that got through by mistake would be refused rather than hang
+  target_type hanging_target(StandInRacer &p_racer);
+
+  //runs a race to the end. r_elapsed is how long it took
+  QTcpSocket *race(QVector<target_type> p_targets, ConnectionRacer &p_racer, qint64 &r_elapsed);
+
+private slots:
+  void initTestCase();
+
+  void single_accepting_target();
+  void refused_target_hands_over_at_once();
+  void hanging_target_is_raced_after_head_start();
+  void first_to_connect_wins();
+  void every_target_refused();
+  void every_target_hanging();
+  void no_targets();
+};
+
+void tst_ConnectionRacer::initTestCase()
+{
+  qRegisterMetaType<QTcpSocket*>();
+
+  QVERIFY(accepting_server.listen(QHostAddress::LocalHost));
+  QVERIFY(second_server.listen(QHostAddress::LocalHost));
+}
+
+target_type tst_ConnectionRacer::accepting_target()
+{
+  return target_type("127.0.0.1", accepting_server.serverPort());
+}
+
+//a port that was just free is as good as guaranteed to refuse
+target_type tst_ConnectionRacer::refusing_target()
+{
+  QTcpServer f_server;
+  f_server.listen(QHostAddress::LocalHost);
+
+  quint16 f_port = f_server.serverPort();
+  f_server.close();
+
+  return target_type("127.0.0.1", f_port);
+}
+
+QTcpSocket *tst_ConnectionRacer::race(QVector<target_type> p_targets, ConnectionRacer &p_racer, qint64 &r_elapsed)
+{
+  p_racer.set_stagger(stagger_milliseconds);
+  p_racer.set_timeout(timeout_milliseconds);
+
+  QSignalSpy f_spy(&p_racer, SIGNAL(finished(QTcpSocket*)));
+  QElapsedTimer f_timer;
+  f_timer.start();
+
+  p_racer.start(p_targets);
+
+  if (f_spy.isEmpty())
+    f_spy.wait(timeout_milliseconds * 3);
+
+  r_elapsed = f_timer.elapsed();
+
+  if (f_spy.count() != 1)
+  {
+    qWarning() << "finished() was emitted" << f_spy.count() << "times";
+    return nullptr;
+  }
+
+  return qvariant_cast<QTcpSocket*>(f_spy.at(0).at(0));
+}
+
+target_type tst_ConnectionRacer::hanging_target(StandInRacer &p_racer)
+{
+  target_type f_target = refusing_target();
+  p_racer.hanging_ports.insert(f_target.second);
+
+  return f_target;
+}
+
+void tst_ConnectionRacer::single_accepting_target()
+{
+  ConnectionRacer f_racer;
+  qint64 f_elapsed;
+
+  QTcpSocket *f_socket = race(QVector<target_type>() << accepting_target(), f_racer, f_elapsed);
+
+  QVERIFY(f_socket != nullptr);
+  QCOMPARE(f_socket->state(), QAbstractSocket::ConnectedState);
+  QCOMPARE(f_socket->peerPort(), accepting_server.serverPort());
+}
+
+void tst_ConnectionRacer::refused_target_hands_over_at_once()
+{
+  ConnectionRacer f_racer;
+  qint64 f_elapsed;
+
+  QTcpSocket *f_socket = race(QVector<target_type>() << refusing_target() << accepting_target(), f_racer, f_elapsed);
+
+  QVERIFY(f_socket != nullptr);
+  QCOMPARE(f_socket->peerPort(), accepting_server.serverPort());
+  //a refusal must not sit out the head start
+  QVERIFY2(f_elapsed < stagger_milliseconds, qPrintable(QString::number(f_elapsed) + " ms"));
+}
+
+void tst_ConnectionRacer::hanging_target_is_raced_after_head_start()
+{
+  StandInRacer f_racer;
+  qint64 f_elapsed;
+
+  QTcpSocket *f_socket = race(QVector<target_type>() << hanging_target(f_racer) << accepting_target(), f_racer, f_elapsed);
+
+  QVERIFY(f_socket != nullptr);
+  QCOMPARE(f_socket->peerPort(), accepting_server.serverPort());
+  //the second target starts once the head start is over, not once the first one times out
+  QVERIFY2(f_elapsed >= stagger_milliseconds - 20, qPrintable(QString::number(f_elapsed) + " ms"));
+  QVERIFY2(f_elapsed < timeout_milliseconds, qPrintable(QString::number(f_elapsed) + " ms"));
+}
+
+void tst_ConnectionRacer::first_to_connect_wins()
+{
+  ConnectionRacer f_racer;
+  qint64 f_elapsed;
+
+  QTcpSocket *f_socket = race(QVector<target_type>() << accepting_target()
+                              << target_type("127.0.0.1", second_server.serverPort()), f_racer, f_elapsed);
+
+  QVERIFY(f_socket != nullptr);
+  QCOMPARE(f_socket->peerPort(), accepting_server.serverPort());
+
+  //the first one connects well within its head start, so the second one is never even tried
+  QTest::qWait(stagger_milliseconds * 2);
+  QVERIFY(!second_server.hasPendingConnections());
+}
+
+void tst_ConnectionRacer::every_target_refused()
+{
+  ConnectionRacer f_racer;
+  qint64 f_elapsed;
+
+  QTcpSocket *f_socket = race(QVector<target_type>() << refusing_target() << refusing_target(), f_racer, f_elapsed);
+
+  QVERIFY(f_socket == nullptr);
+  QVERIFY2(f_elapsed < stagger_milliseconds, qPrintable(QString::number(f_elapsed) + " ms"));
+}
+
+void tst_ConnectionRacer::every_target_hanging()
+{
+  StandInRacer f_racer;
+  qint64 f_elapsed;
+
+  QTcpSocket *f_socket = race(QVector<target_type>() << hanging_target(f_racer) << hanging_target(f_racer), f_racer, f_elapsed);
+
+  QVERIFY(f_socket == nullptr);
+  QVERIFY2(f_elapsed >= timeout_milliseconds - 20, qPrintable(QString::number(f_elapsed) + " ms"));
+}
+
+void tst_ConnectionRacer::no_targets()
+{
+  ConnectionRacer f_racer;
+  qint64 f_elapsed;
+
+  QVERIFY(race(QVector<target_type>(), f_racer, f_elapsed) == nullptr);
+}
+
+QTEST_GUILESS_MAIN(tst_ConnectionRacer)
+
+#include "tst_connectionracer.moc"
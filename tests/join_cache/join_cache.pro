@@ -0,0 +1,22 @@
+#-------------------------------------------------
+#
+# joins a local stand-in server, caches the lists it sent and checks that the cache gives the same lists back
+#
+#-------------------------------------------------
+
+QT       += core network testlib
+QT       -= gui
+
+CONFIG   += console c++11 testcase
+CONFIG   -= app_bundle
+
+TARGET = tst_joincache
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../..
+
+SOURCES += tst_joincache.cpp \
+    $$PWD/../../joincache.cpp \
+    $$PWD/../../aopacket.cpp \
+    $$PWD/../../packetframer.cpp \
+    $$PWD/../../encryption_functions.cpp
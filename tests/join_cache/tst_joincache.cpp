@@ -0,0 +1,373 @@
+#include "joincache.h"
+#include "aopacket.h"
+#include "packetframer.h"
+
+#include <QtTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+//answers the join handshake from fixed lists, the way tsuserver does: SI with the sizes, SC and SM with
+//every character and song in one packet, and one EI per AE request
+class StandInServer : public QObject
+{
+  Q_OBJECT
+
+public:
+  StandInServer();
+
+  QTcpServer server;
+  join_cache_type lists;
+
+private:
+  QTcpSocket *m_client = nullptr;
+  PacketFramer m_framer;
+
+  //every subfield is escaped on its own, the & between them is not
+  static QString escape(QString p_text);
+  void send(QString p_packet);
+
+private slots:
+  void on_new_connection();
+  void on_ready_read();
+};
+
+StandInServer::StandInServer()
+{
+  for (QString i_name : QStringList{"Phoenix", "Miles Edgeworth", "Maya Fey", "Franziska von Karma", "逆転検事", "Gumshoe #1", "50% Judge"})
+  {
+    char_type f_char;
+    f_char.name = i_name;
+    f_char.description = "Costs $5 and is " + i_name + "'s";
+    f_char.taken = false;
+    lists.chars.append(f_char);
+  }
+
+  for (int n_evi = 0 ; n_evi < 4 ; ++n_evi)
+  {
+    evi_type f_evi;
+    f_evi.name = "Exhibit #" + QString::number(n_evi + 1);
+    f_evi.description = "Found at 100% of crime scenes, number " + QString::number(n_evi);
+    f_evi.image = "evidence_" + QString::number(n_evi) + ".png";
+    lists.evidence.append(f_evi);
+  }
+
+  lists.music = {"Lobby", "Courtroom 1", "Detention Center", "Trials & Tribulations.mp3", "Cornered #2 (100%).mp3",
+                 "逆転裁判 - 追求.mp3"};
+
+  connect(&server, SIGNAL(newConnection()), this, SLOT(on_new_connection()));
+}
+
+QString StandInServer::escape(QString p_text)
+{
+  return p_text.replace("#", "<num>").replace("%", "<percent>").replace("$", "<dollar>").replace("&", "<and>");
+}
+
+void StandInServer::send(QString p_packet)
+{
+  m_client->write(p_packet.toUtf8());
+}
+
+void StandInServer::on_new_connection()
+{
+  m_client = server.nextPendingConnection();
+  connect(m_client, SIGNAL(readyRead()), this, SLOT(on_ready_read()));
+
+  //the first request may have come in along with the connection
+  if (m_client->bytesAvailable() > 0)
+    on_ready_read();
+}
+
+void StandInServer::on_ready_read()
+{
+  m_framer.append(m_client->readAll());
+
+  QByteArray f_frame;
+
+  while (m_framer.next_frame(f_frame))
+  {
+    AOPacket f_packet(QString::fromUtf8(f_frame.constData(), f_frame.size()));
+    QString f_header = f_packet.get_header();
+
+    if (f_header == "askchaa")
+    {
+      send("SI#" + QString::number(lists.chars.size()) + "#" + QString::number(lists.evidence.size()) + "#" +
+           QString::number(lists.music.size()) + "#%");
+    }
+    else if (f_header == "RC")
+    {
+      QString f_sc = "SC";
+
+      for (char_type i_char : lists.chars)
+        f_sc += "#" + escape(i_char.name) + "&" + escape(i_char.description);
+
+      send(f_sc + "#%");
+    }
+    else if (f_header == "AE")
+    {
+      int f_index = f_packet.get_field(0).toInt();
+      evi_type f_evi = lists.evidence.value(f_index - 1);
+
+      send("EI#" + QString::number(f_index) + "#" + escape(f_evi.name) + "&" + escape(f_evi.description) + "&0&" +
+           escape(f_evi.image) + "#%");
+    }
+    else if (f_header == "RM")
+    {
+      QString f_sm = "SM";
+
+      for (QString i_song : lists.music)
+        f_sm += "#" + escape(i_song);
+
+      send(f_sm + "#%");
+    }
+    else if (f_header == "RD")
+    {
+      send("DONE#%");
+    }
+  }
+}
+
+class tst_JoinCache : public QObject
+{
+  Q_OBJECT
+
+private:
+  StandInServer m_server;
+  QTemporaryDir m_base_path;
+
+  QTcpSocket m_socket;
+  PacketFramer m_framer;
+
+  //what the join handed over, parsed the way the packet handlers parse it
+  join_cache_type m_fresh;
+  int m_si_chars = 0;
+  int m_si_evidence = 0;
+  int m_si_music = 0;
+
+  //sends p_request and waits for the one packet that answers it. nullptr if none came
+  AOPacket *exchange(QString p_request);
+  void join();
+
+  server_type stand_in_server();
+  static void compare_lists(const join_cache_type &p_actual, const join_cache_type &p_expected);
+
+private slots:
+  void initTestCase();
+
+  void fresh_lists_match_server();
+  void cached_lists_match_fresh();
+  void changed_lists_miss();
+  void corrupt_cache_misses();
+};
+
+AOPacket *tst_JoinCache::exchange(QString p_request)
+{
+  QSignalSpy f_spy(&m_socket, SIGNAL(readyRead()));
+
+  m_socket.write(p_request.toUtf8());
+
+  QByteArray f_frame;
+
+  while (!m_framer.next_frame(f_frame))
+  {
+    if (!f_spy.wait(5000))
+      return nullptr;
+
+    m_framer.append(m_socket.readAll());
+  }
+
+  AOPacket *f_packet = new AOPacket(QString::fromUtf8(f_frame.constData(), f_frame.size()));
+  f_packet->net_decode();
+
+  return f_packet;
+}
+
+//the improved loading handshake, with the evidence asked for one by one like the legacy one does
+void tst_JoinCache::join()
+{
+  QScopedPointer<AOPacket> f_si(exchange("askchaa#%"));
+  QVERIFY(!f_si.isNull());
+  QCOMPARE(f_si->get_header(), QString("SI"));
+  QCOMPARE(f_si->get_field_count(), 3);
+
+  m_si_chars = f_si->get_field(0).toInt();
+  m_si_evidence = f_si->get_field(1).toInt();
+  m_si_music = f_si->get_field(2).toInt();
+
+  QScopedPointer<AOPacket> f_sc(exchange("RC#%"));
+  QVERIFY(!f_sc.isNull());
+  QCOMPARE(f_sc->get_header(), QString("SC"));
+
+  for (int n_element = 0 ; n_element < f_sc->get_field_count() ; ++n_element)
+  {
+    QStringList sub_elements = f_sc->get_field(n_element).split("&");
+
+    char_type f_char;
+    f_char.name = sub_elements.at(0);
+    if (sub_elements.size() >= 2)
+      f_char.description = sub_elements.at(1);
+    f_char.taken = false;
+
+    m_fresh.chars.append(f_char);
+  }
+
+  for (int n_evi = 1 ; n_evi <= m_si_evidence ; ++n_evi)
+  {
+    QScopedPointer<AOPacket> f_ei(exchange("AE#" + QString::number(n_evi) + "#%"));
+    QVERIFY(!f_ei.isNull());
+    QCOMPARE(f_ei->get_header(), QString("EI"));
+    QVERIFY(f_ei->get_field_count() >= 2);
+
+    QStringList sub_elements = f_ei->get_field(1).split("&");
+    QVERIFY(sub_elements.size() >= 4);
+
+    evi_type f_evi;
+    f_evi.name = sub_elements.at(0);
+    f_evi.description = sub_elements.at(1);
+    f_evi.image = sub_elements.at(3);
+
+    m_fresh.evidence.append(f_evi);
+  }
+
+  QScopedPointer<AOPacket> f_sm(exchange("RM#%"));
+  QVERIFY(!f_sm.isNull());
+  QCOMPARE(f_sm->get_header(), QString("SM"));
+
+  for (int n_element = 0 ; n_element < f_sm->get_field_count() ; ++n_element)
+    m_fresh.music.append(f_sm->get_field(n_element));
+
+  QScopedPointer<AOPacket> f_done(exchange("RD#%"));
+  QVERIFY(!f_done.isNull());
+  QCOMPARE(f_done->get_header(), QString("DONE"));
+}
+
+server_type tst_JoinCache::stand_in_server()
+{
+  server_type f_server;
+  f_server.name = "stand-in";
+  f_server.ip = "127.0.0.1";
+  f_server.port = m_server.server.serverPort();
+
+  return f_server;
+}
+
+void tst_JoinCache::compare_lists(const join_cache_type &p_actual, const join_cache_type &p_expected)
+{
+  QCOMPARE(p_actual.chars.size(), p_expected.chars.size());
+
+  for (int n_char = 0 ; n_char < p_expected.chars.size() ; ++n_char)
+  {
+    QCOMPARE(p_actual.chars.at(n_char).name, p_expected.chars.at(n_char).name);
+    QCOMPARE(p_actual.chars.at(n_char).description, p_expected.chars.at(n_char).description);
+    QCOMPARE(p_actual.chars.at(n_char).evidence_string, p_expected.chars.at(n_char).evidence_string);
+    QCOMPARE(p_actual.chars.at(n_char).taken, p_expected.chars.at(n_char).taken);
+  }
+
+  QCOMPARE(p_actual.evidence.size(), p_expected.evidence.size());
+
+  for (int n_evi = 0 ; n_evi < p_expected.evidence.size() ; ++n_evi)
+  {
+    QCOMPARE(p_actual.evidence.at(n_evi).name, p_expected.evidence.at(n_evi).name);
+    QCOMPARE(p_actual.evidence.at(n_evi).description, p_expected.evidence.at(n_evi).description);
+    QCOMPARE(p_actual.evidence.at(n_evi).image, p_expected.evidence.at(n_evi).image);
+  }
+
+  QCOMPARE(p_actual.music, p_expected.music);
+}
+
+void tst_JoinCache::initTestCase()
+{
+  QVERIFY(m_base_path.isValid());
+  QVERIFY(m_server.server.listen(QHostAddress::LocalHost));
+
+  QSignalSpy f_connected(&m_socket, SIGNAL(connected()));
+  m_socket.connectToHost("127.0.0.1", m_server.server.serverPort());
+  QVERIFY(f_connected.count() == 1 || f_connected.wait(5000));
+
+  join();
+}
+
+void tst_JoinCache::fresh_lists_match_server()
+{
+  QCOMPARE(m_si_chars, m_server.lists.chars.size());
+  QCOMPARE(m_si_evidence, m_server.lists.evidence.size());
+  QCOMPARE(m_si_music, m_server.lists.music.size());
+
+  compare_lists(m_fresh, m_server.lists);
+}
+
+void tst_JoinCache::cached_lists_match_fresh()
+{
+  QString f_key = get_join_cache_key(stand_in_server(), m_si_chars, m_si_evidence, m_si_music, "");
+  QString f_path = get_join_cache_path(m_base_path.path() + "/", f_key);
+
+  QVERIFY(write_join_cache(f_path, f_key, m_fresh));
+
+  join_cache_type f_cached;
+  QVERIFY(read_join_cache(f_path, f_key, f_cached));
+
+  compare_lists(f_cached, m_fresh);
+}
+
+void tst_JoinCache::changed_lists_miss()
+{
+  QString f_key = get_join_cache_key(stand_in_server(), m_si_chars, m_si_evidence, m_si_music, "");
+  QString f_path = get_join_cache_path(m_base_path.path() + "/", f_key);
+
+  QVERIFY(write_join_cache(f_path, f_key, m_fresh));
+
+  //one more song, another digest, another port: each is a different cache
+  QStringList f_other_keys = {
+    get_join_cache_key(stand_in_server(), m_si_chars, m_si_evidence, m_si_music + 1, ""),
+    get_join_cache_key(stand_in_server(), m_si_chars, m_si_evidence, m_si_music, "abc123"),
+    get_join_cache_key(server_type{"", "", "127.0.0.1", m_server.server.serverPort() + 1}, m_si_chars, m_si_evidence,
+                       m_si_music, "")
+  };
+
+  for (QString i_key : f_other_keys)
+  {
+    join_cache_type f_cached;
+
+    QVERIFY(get_join_cache_path(m_base_path.path() + "/", i_key) != f_path);
+    QVERIFY(!read_join_cache(get_join_cache_path(m_base_path.path() + "/", i_key), i_key, f_cached));
+    //even if the file names collided, the key stored inside has to match
+    QVERIFY(!read_join_cache(f_path, i_key, f_cached));
+  }
+}
+
+void tst_JoinCache::corrupt_cache_misses()
+{
+  QString f_key = get_join_cache_key(stand_in_server(), m_si_chars, m_si_evidence, m_si_music, "");
+  QString f_path = get_join_cache_path(m_base_path.path() + "/", f_key);
+
+  QVERIFY(write_join_cache(f_path, f_key, m_fresh));
+
+  QFile f_file(f_path);
+  QVERIFY(f_file.open(QIODevice::ReadOnly));
+  QByteArray f_data = f_file.readAll();
+  f_file.close();
+
+  join_cache_type f_cached;
+
+  QVERIFY(f_file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+  f_file.write(f_data.left(f_data.size() / 2));
+  f_file.close();
+
+  QVERIFY(!read_join_cache(f_path, f_key, f_cached));
+
+  QByteArray f_bad_magic = f_data;
+  f_bad_magic[0] = static_cast<char>(f_bad_magic.at(0) ^ 0xFF);
+
+  QVERIFY(f_file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+  f_file.write(f_bad_magic);
+  f_file.close();
+
+  QVERIFY(!read_join_cache(f_path, f_key, f_cached));
+  //a miss leaves the lists alone
+  QVERIFY(f_cached.chars.isEmpty() && f_cached.evidence.isEmpty() && f_cached.music.isEmpty());
+}
+
+QTEST_GUILESS_MAIN(tst_JoinCache)
+
+#include "tst_joincache.moc"
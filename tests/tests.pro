@@ -0,0 +1,10 @@
+#-------------------------------------------------
+#
+# checks that run against local stand-ins instead of a live server, "make check" runs all of them
+#
+#-------------------------------------------------
+
+TEMPLATE = subdirs
+
+SUBDIRS += connectionracer \
+    join_cache
@@ -1,45 +1,21 @@
 #include "aoapplication.h"
 
 #include "file_functions.h"
+#include "charprofilecache.h"
+#include "themeresolver.h"
+#include "configstore.h"
+#include "callwordmatcher.h"
 
 #include <QTextStream>
 #include <QStringList>
 #include <QVector>
+#include <QSet>
 #include <QDebug>
 #include <QColor>
 
 QString AOApplication::read_config(QString searchline)
 {
-  QString return_value = "";
-
-  QFile config_file(get_base_path() + "config.ini");
-  if (!config_file.open(QIODevice::ReadOnly))
-      return return_value;
-
-  QTextStream in(&config_file);
-
-  while(!in.atEnd())
-  {
-    QString f_line = in.readLine().trimmed();
-
-    if (!f_line.startsWith(searchline))
-      continue;
-
-    QStringList line_elements = f_line.split("=");
-
-    if (line_elements.at(0).trimmed() != searchline)
-      continue;
-
-    if (line_elements.size() < 2)
-      continue;
-
-    return_value = line_elements.at(1).trimmed();
-    break;
-  }
-
-  config_file.close();
-
-  return return_value;
+  return config_store->get_value(searchline);
 }
 
 QString AOApplication::read_user_theme()
@@ -65,51 +41,22 @@ int AOApplication::read_blip_rate()
 
 int AOApplication::get_default_music()
 {
-  QString f_result = read_config("default_music");
-
-  if (f_result == "")
-    return 50;
-  else return f_result.toInt();
+  return config_store->get_int("default_music", 50);
 }
 
 int AOApplication::get_default_sfx()
 {
-  QString f_result = read_config("default_sfx");
-
-  if (f_result == "")
-    return 50;
-  else return f_result.toInt();
+  return config_store->get_int("default_sfx", 50);
 }
 
 int AOApplication::get_default_blip()
 {
-  QString f_result = read_config("default_blip");
-
-  if (f_result == "")
-    return 50;
-  else return f_result.toInt();
+  return config_store->get_int("default_blip", 50);
 }
 
 QStringList AOApplication::get_call_words()
 {
-  QStringList return_value;
-
-  QFile callwords_ini;
-
-  callwords_ini.setFileName(get_base_path() + "callwords.ini");
-
-  if (!callwords_ini.open(QIODevice::ReadOnly))
-    return return_value;
-
-  QTextStream in(&callwords_ini);
-
-  while (!in.atEnd())
-  {
-    QString line = in.readLine();
-    return_value.append(line);
-  }
-
-  return return_value;
+  return call_words->get_words();
 }
 
 void AOApplication::write_to_serverlist_txt(QString p_line)
@@ -167,49 +114,9 @@ QVector<server_type> AOApplication::read_serverlist_txt()
   return f_server_list;
 }
 
-QString AOApplication::read_design_ini(QString p_identifier, QString p_design_path)
-{
-  QFile design_ini;
-
-  design_ini.setFileName(p_design_path);
-
-  if (!design_ini.open(QIODevice::ReadOnly))
-  {
-    return "";
-  }
-  QTextStream in(&design_ini);
-
-  QString result = "";
-
-  while (!in.atEnd())
-  {
-    QString f_line = in.readLine().trimmed();
-
-    if (!f_line.startsWith(p_identifier))
-      continue;
-
-    QStringList line_elements = f_line.split("=");
-
-    if (line_elements.at(0).trimmed() != p_identifier)
-      continue;
-
-    if (line_elements.size() < 2)
-      continue;
-
-    result = line_elements.at(1).trimmed();
-    break;
-  }
-
-  design_ini.close();
-
-  return result;
-}
-
 QPoint AOApplication::get_button_spacing(QString p_identifier, QString p_file)
 {
-  QString design_ini_path = get_theme_path() + p_file;
-  QString default_path = get_default_theme_path() + p_file;
-  QString f_result = read_design_ini(p_identifier, design_ini_path);
+  QString f_result = theme_resolver->get_value(p_identifier, p_file);
 
   QPoint return_value;
 
@@ -217,12 +124,7 @@ QPoint AOApplication::get_button_spacing(QString p_identifier, QString p_file)
   return_value.setY(0);
 
   if (f_result == "")
-  {
-    f_result = read_design_ini(p_identifier, default_path);
-
-    if (f_result == "")
-      return return_value;
-  }
+    return return_value;
 
   QStringList sub_line_elements = f_result.split(",");
 
@@ -237,9 +139,7 @@ QPoint AOApplication::get_button_spacing(QString p_identifier, QString p_file)
 
 pos_size_type AOApplication::get_element_dimensions(QString p_identifier, QString p_file)
 {
-  QString design_ini_path = get_theme_path() + p_file;
-  QString default_path = get_default_theme_path() + p_file;
-  QString f_result = read_design_ini(p_identifier, design_ini_path);
+  QString f_result = theme_resolver->get_value(p_identifier, p_file);
 
   pos_size_type return_value;
 
@@ -249,12 +149,7 @@ pos_size_type AOApplication::get_element_dimensions(QString p_identifier, QStrin
   return_value.height = -1;
 
   if (f_result == "")
-  {
-    f_result = read_design_ini(p_identifier, default_path);
-
-    if (f_result == "")
-      return return_value;
-  }
+    return return_value;
 
   QStringList sub_line_elements = f_result.split(",");
 
@@ -271,36 +166,22 @@ pos_size_type AOApplication::get_element_dimensions(QString p_identifier, QStrin
 
 int AOApplication::get_font_size(QString p_identifier, QString p_file)
 {
-  QString design_ini_path = get_theme_path() + p_file;
-  QString default_path = get_default_theme_path() + p_file;
-  QString f_result = read_design_ini(p_identifier, design_ini_path);
+  QString f_result = theme_resolver->get_value(p_identifier, p_file);
 
   if (f_result == "")
-  {
-    f_result = read_design_ini(p_identifier, default_path);
-
-    if (f_result == "")
-      return 10;
-  }
+    return 10;
 
   return f_result.toInt();
 }
 
 QColor AOApplication::get_color(QString p_identifier, QString p_file)
 {
-  QString design_ini_path = get_theme_path() + p_file;
-  QString default_path = get_default_theme_path() + p_file;
-  QString f_result = read_design_ini(p_identifier, design_ini_path);
+  QString f_result = theme_resolver->get_value(p_identifier, p_file);
 
   QColor return_color(255, 255, 255);
 
   if (f_result == "")
-  {
-    f_result = read_design_ini(p_identifier, default_path);
-
-    if (f_result == "")
-      return return_color;
-  }
+    return return_color;
 
   QStringList color_list = f_result.split(",");
 
@@ -316,80 +197,80 @@ QColor AOApplication::get_color(QString p_identifier, QString p_file)
 
 QString AOApplication::get_sfx(QString p_identifier)
 {
-  QString design_ini_path = get_theme_path() + "courtroom_sounds.ini";
-  QString default_path = get_default_theme_path() + "courtroom_sounds.ini";
-  QString f_result = read_design_ini(p_identifier, design_ini_path);
-
-  QString return_sfx = "";
-
-  if (f_result == "")
-  {
-    f_result = read_design_ini(p_identifier, default_path);
-
-    if (f_result == "")
-      return return_sfx;
-  }
-
-  return_sfx = f_result;
-
-  return return_sfx;
+  return theme_resolver->get_value(p_identifier, "courtroom_sounds.ini");
 }
 
-//returns whatever is to the right of "search_line =" within target_tag and terminator_tag, trimmed
-//returns the empty string if the search line couldnt be found
-QString AOApplication::read_char_ini(QString p_char, QString p_search_line, QString target_tag, QString terminator_tag)
+char_profile_type AOApplication::get_char_profile(QString p_char)
 {
-  QString char_ini_path = get_character_path(p_char) + "char.ini";
-
-  QFile char_ini;
-
-  char_ini.setFileName(char_ini_path);
-
-  if (!char_ini.open(QIODevice::ReadOnly))
-    return "";
+  return char_profiles->get_profile(resolve_path(get_character_path(p_char) + "char.ini"));
+}
 
-  QTextStream in(&char_ini);
+void AOApplication::prefetch_char_profiles(const QVector<char_type> &p_chars)
+{
+  QStringList f_chars;
+  QSet<QString> f_listed;
 
-  bool tag_found = false;
+  for (char_type i_char : p_chars)
+    f_listed.insert(i_char.name);
 
-  while(!in.atEnd())
+  //whoever spoke recently is likely to speak again soon
+  for (QString i_speaker : recent_speakers)
   {
-    QString line = in.readLine();
-
-    if (QString::compare(line, terminator_tag, Qt::CaseInsensitive) == 0)
-      break;
-
-    if (line.startsWith(target_tag, Qt::CaseInsensitive))
-    {
-      tag_found = true;
-      continue;
-    }
+    if (f_listed.remove(i_speaker))
+      f_chars.append(i_speaker);
+  }
 
-    if (!line.startsWith(p_search_line, Qt::CaseInsensitive))
-      continue;
+  for (char_type i_char : p_chars)
+  {
+    if (f_listed.remove(i_char.name))
+      f_chars.append(i_char.name);
+  }
 
-    QStringList line_elements = line.split("=");
+  char_profiles->set_prefetch_threads(get_prefetch_threads());
+  char_profiles->set_max_profiles(get_char_profile_cache_size());
+  char_profiles->prefetch(get_base_path() + "characters/", f_chars);
+}
 
-    if (QString::compare(line_elements.at(0).trimmed(), p_search_line, Qt::CaseInsensitive) != 0)
-      continue;
+void AOApplication::note_speaker(QString p_char)
+{
+  if (p_char == "")
+    return;
 
-    if (line_elements.size() < 2)
-      continue;
+  recent_speakers.removeOne(p_char);
+  recent_speakers.prepend(p_char);
 
-    if (tag_found)
-    {
-      char_ini.close();
-      return line_elements.at(1).trimmed();
-    }
-  }
+  if (recent_speakers.size() > max_recent_speakers)
+    recent_speakers.removeLast();
+}
 
-  char_ini.close();
-  return "";
+//returns whatever is to the right of "search_line =" within the target_tag section of char.ini, trimmed
+//returns the empty string if the search line couldnt be found
+QString AOApplication::read_char_ini(QString p_char, QString p_search_line, QString target_tag)
+{
+  char_profile_type f_profile = get_char_profile(p_char);
+
+  QString f_key = p_search_line.toLower();
+  QString f_tag = target_tag.toLower();
+
+  if (f_tag == "[options]")
+    return f_profile.options.value(f_key);
+  else if (f_tag == "[time]")
+    return f_profile.time.value(f_key);
+  else if (f_tag == "[emotions]")
+    return f_profile.emotions.value(f_key);
+  else if (f_tag == "[soundn]")
+    return f_profile.sound_n.value(f_key);
+  else if (f_tag == "[soundt]")
+    return f_profile.sound_t.value(f_key);
+  else if (f_tag == "[textdelay]")
+    return f_profile.text_delay.value(f_key);
+  else
+    return "";
 }
 
 QString AOApplication::get_char_name(QString p_char)
 {
-  QString f_result = read_char_ini(p_char, "name", "[Options]", "[Time]");
+  QString f_result = read_char_ini(p_char, "name", "[Options]");
 
   if (f_result == "")
     return p_char;
@@ -398,7 +279,7 @@ QString AOApplication::get_char_name(QString p_char)
 
 QString AOApplication::get_showname(QString p_char)
 {
-  QString f_result = read_char_ini(p_char, "showname", "[Options]", "[Time]");
+  QString f_result = read_char_ini(p_char, "showname", "[Options]");
 
   if (f_result == "")
     return p_char;
@@ -407,7 +288,7 @@ QString AOApplication::get_showname(QString p_char)
 
 QString AOApplication::get_char_side(QString p_char)
 {
-  QString f_result = read_char_ini(p_char, "side", "[Options]", "[Time]");
+  QString f_result = read_char_ini(p_char, "side", "[Options]");
 
   if (f_result == "")
     return "wit";
@@ -416,7 +297,7 @@ QString AOApplication::get_char_side(QString p_char)
 
 QString AOApplication::get_gender(QString p_char)
 {
-  QString f_result = read_char_ini(p_char, "gender", "[Options]", "[Time]");
+  QString f_result = read_char_ini(p_char, "gender", "[Options]");
 
   if (f_result == "")
     return "male";
@@ -425,7 +306,7 @@ QString AOApplication::get_gender(QString p_char)
 
 QString AOApplication::get_chat(QString p_char)
 {
-  QString f_result = read_char_ini(p_char, "chat", "[Options]", "[Time]");
+  QString f_result = read_char_ini(p_char, "chat", "[Options]");
 
   //handling the correct order of chat is a bit complicated, we let the caller do it
   return f_result.toLower();
@@ -433,14 +314,14 @@ QString AOApplication::get_chat(QString p_char)
 
 QString AOApplication::get_char_shouts(QString p_char)
 {
-  QString f_result = read_char_ini(p_char, "shouts", "[Options]", "[Time]");
+  QString f_result = read_char_ini(p_char, "shouts", "[Options]");
 
   return f_result.toLower();
 }
 
 int AOApplication::get_preanim_duration(QString p_char, QString p_emote)
 {
-  QString f_result = read_char_ini(p_char, p_emote, "[Time]", "[Emotions]");
+  QString f_result = read_char_ini(p_char, p_emote, "[Time]");
 
   if (f_result == "")
     return -1;
@@ -449,7 +330,7 @@ int AOApplication::get_preanim_duration(QString p_char, QString p_emote)
 
 int AOApplication::get_ao2_preanim_duration(QString p_char, QString p_emote)
 {
-  QString f_result = read_char_ini(p_char, "%" + p_emote, "[Time]", "[Emotions]");
+  QString f_result = read_char_ini(p_char, "%" + p_emote, "[Time]");
 
   if (f_result == "")
     return -1;
@@ -458,121 +339,112 @@ int AOApplication::get_ao2_preanim_duration(QString p_char, QString p_emote)
 
 int AOApplication::get_emote_number(QString p_char)
 {
-  QString f_result = read_char_ini(p_char, "number", "[Emotions]", "[SoundN]");
+  QString f_result = read_char_ini(p_char, "number", "[Emotions]");
 
   if (f_result == "")
     return 0;
   else return f_result.toInt();
 }
 
-QString AOApplication::get_emote_comment(QString p_char, int p_emote)
+QVector<emote_type> AOApplication::get_emote_list(QString p_char)
 {
-  QString f_result = read_char_ini(p_char, QString::number(p_emote + 1), "[Emotions]", "[SoundN]");
+  return get_char_profile(p_char).emote_list;
+}
 
-  QStringList result_contents = f_result.split("#");
+emote_type AOApplication::get_emote_info(QString p_char, int p_emote)
+{
+  return get_char_profile(p_char).emote_list.value(p_emote);
+}
 
-  if (result_contents.size() < 4)
-  {
-    qDebug() << "W: misformatted char.ini: " << p_char << ", " << p_emote;
-    return "normal";
-  }
-  else return result_contents.at(0);
+QString AOApplication::get_emote_comment(QString p_char, int p_emote)
+{
+  return get_emote_info(p_char, p_emote).comment;
 }
 
 QString AOApplication::get_pre_emote(QString p_char, int p_emote)
 {
-  QString f_result = read_char_ini(p_char, QString::number(p_emote + 1), "[Emotions]", "[SoundN]");
-
-  QStringList result_contents = f_result.split("#");
-
-  if (result_contents.size() < 4)
-  {
-    qDebug() << "W: misformatted char.ini: " << p_char << ", " << p_emote;
-    return "";
-  }
-  else return result_contents.at(1);
+  return get_emote_info(p_char, p_emote).preanim;
 }
 
 QString AOApplication::get_emote(QString p_char, int p_emote)
 {
-  QString f_result = read_char_ini(p_char, QString::number(p_emote + 1), "[Emotions]", "[SoundN]");
-
-  QStringList result_contents = f_result.split("#");
-
-  if (result_contents.size() < 4)
-  {
-    qDebug() << "W: misformatted char.ini: " << p_char << ", " << p_emote;
-    return "normal";
-  }
-  else return result_contents.at(2);
+  return get_emote_info(p_char, p_emote).anim;
 }
 
 int AOApplication::get_emote_mod(QString p_char, int p_emote)
 {
-  QString f_result = read_char_ini(p_char, QString::number(p_emote + 1), "[Emotions]", "[SoundN]");
-
-  QStringList result_contents = f_result.split("#");
-
-  if (result_contents.size() < 4)
-  {
-    qDebug() << "W: misformatted char.ini: " << p_char << ", " << QString::number(p_emote);
-    return 0;
-  }
-  else return result_contents.at(3).toInt();
+  return get_emote_info(p_char, p_emote).mod;
 }
 
 int AOApplication::get_desk_mod(QString p_char, int p_emote)
 {
-  QString f_result = read_char_ini(p_char, QString::number(p_emote + 1), "[Emotions]", "[SoundN]");
-
-  QStringList result_contents = f_result.split("#");
-
-  if (result_contents.size() < 5)
-    return -1;
-
-  QString string_result = result_contents.at(4);
-  if (string_result == "")
-    return -1;
-
-  else return string_result.toInt();
+  return get_emote_info(p_char, p_emote).desk_mod;
 }
 
 QString AOApplication::get_sfx_name(QString p_char, int p_emote)
 {
-  QString f_result = read_char_ini(p_char, QString::number(p_emote + 1), "[SoundN]", "[SoundT]");
-
-  if (f_result == "")
-    return "1";
-  else return f_result;
+  return get_emote_info(p_char, p_emote).sfx_name;
 }
 
 int AOApplication::get_sfx_delay(QString p_char, int p_emote)
 {
-  QString f_result = read_char_ini(p_char, QString::number(p_emote + 1), "[SoundT]", "[TextDelay]");
-
-  if (f_result == "")
-    return 1;
-  else return f_result.toInt();
+  return get_emote_info(p_char, p_emote).sfx_delay;
 }
 
 int AOApplication::get_text_delay(QString p_char, QString p_emote)
 {
-  QString f_result = read_char_ini(p_char, p_emote, "[TextDelay]", "END_OF_FILE");
+  QString f_result = read_char_ini(p_char, p_emote, "[TextDelay]");
 
   if (f_result == "")
     return -1;
   else return f_result.toInt();
 }
 
+int AOApplication::get_loading_window()
+{
+  QString f_result = read_config("loading_window");
+
+  if (f_result == "" || f_result.toInt() < 1)
+    return 8;
+  else return f_result.toInt();
+}
+
 bool AOApplication::get_blank_blip()
 {
-  QString f_result = read_config("blank_blip");
+  return config_store->get_bool("blank_blip");
+}
 
-  return f_result.startsWith("true");
+bool AOApplication::get_timed_preanims()
+{
+  return config_store->get_bool("timed_preanims");
 }
 
+bool AOApplication::get_tcp_nodelay()
+{
+  return config_store->get_bool("tcp_nodelay");
+}
 
+int AOApplication::get_prefetch_threads()
+{
+  return config_store->get_int("prefetch_threads", 2);
+}
 
+int AOApplication::get_char_profile_cache_size()
+{
+  return config_store->get_int("char_profile_cache", 256);
+}
 
+int AOApplication::get_frame_cache_size()
+{
+  return config_store->get_int("frame_cache_mb", 128);
+}
 
+int AOApplication::get_decode_threads()
+{
+  return config_store->get_int("decode_threads", 2);
+}
 
+bool AOApplication::get_smooth_scaling()
+{
+  return config_store->get_value("image_quality").trimmed() == "smooth";
+}
@@ -0,0 +1,102 @@
+#include "themeresolver.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QMutexLocker>
+
+ThemeResolver::ThemeResolver()
+{
+
+}
+
+void ThemeResolver::set_theme(QString p_theme_path, QString p_default_theme_path)
+{
+  {
+    QMutexLocker locker(&m_mutex);
+
+    if (m_theme_set && p_theme_path == m_theme_path && p_default_theme_path == m_default_theme_path)
+      return;
+  }
+
+  //parsed without the lock, lookups from other threads keep getting the old theme until the new one is in
+  QHash<QString, QHash<QString, QString>> f_files;
+
+  for (QString i_file : get_theme_files())
+    f_files.insert(i_file, parse_theme_file(p_theme_path, p_default_theme_path, i_file));
+
+  QMutexLocker locker(&m_mutex);
+
+  m_theme_set = true;
+  m_theme_path = p_theme_path;
+  m_default_theme_path = p_default_theme_path;
+  m_files = f_files;
+}
+
+QString ThemeResolver::get_value(QString p_identifier, QString p_file)
+{
+  QMutexLocker locker(&m_mutex);
+
+  QHash<QString, QHash<QString, QString>>::const_iterator f_file = m_files.constFind(p_file);
+
+  //not one of the usual files, so it gets parsed the first time it is asked for
+  if (f_file == m_files.constEnd())
+    f_file = m_files.insert(p_file, parse_theme_file(m_theme_path, m_default_theme_path, p_file));
+
+  return f_file->value(p_identifier);
+}
+
+QStringList ThemeResolver::get_theme_files()
+{
+  return QStringList() << "courtroom_design.ini" << "courtroom_fonts.ini" << "lobby_design.ini" << "courtroom_sounds.ini";
+}
+
+QHash<QString, QString> ThemeResolver::parse_theme_file(QString p_theme_path, QString p_default_theme_path, QString p_file)
+{
+  QHash<QString, QString> f_values = parse_design_ini(p_theme_path + p_file);
+
+  if (p_default_theme_path == p_theme_path)
+    return f_values;
+
+  QHash<QString, QString> f_default_values = parse_design_ini(p_default_theme_path + p_file);
+
+  //an identifier the theme leaves empty counts as missing
+  for (QHash<QString, QString>::const_iterator i_value = f_default_values.constBegin() ; i_value != f_default_values.constEnd() ; ++i_value)
+  {
+    if (f_values.value(i_value.key()) == "")
+      f_values.insert(i_value.key(), i_value.value());
+  }
+
+  return f_values;
+}
+
+//identifiers are case sensitive and the first line for one counts, a line without = doesn't
+QHash<QString, QString> ThemeResolver::parse_design_ini(QString p_path)
+{
+  QHash<QString, QString> f_values;
+
+  QFile design_ini(p_path);
+
+  if (!design_ini.open(QIODevice::ReadOnly))
+    return f_values;
+
+  QTextStream in(&design_ini);
+
+  while (!in.atEnd())
+  {
+    QString f_line = in.readLine().trimmed();
+
+    QStringList line_elements = f_line.split("=");
+
+    if (line_elements.size() < 2)
+      continue;
+
+    QString f_identifier = line_elements.at(0).trimmed();
+
+    if (!f_values.contains(f_identifier))
+      f_values.insert(f_identifier, line_elements.at(1).trimmed());
+  }
+
+  design_ini.close();
+
+  return f_values;
+}
@@ -0,0 +1,43 @@
+#ifndef THEMERESOLVER_H
+#define THEMERESOLVER_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QMutex>
+
+//keeps the design and sound inis of the current theme in memory, with the default theme merged in
+//a theme change reparses them right away, they're small and the widgets ask for them next thing anyway
+//the resolver is thread safe
+class ThemeResolver
+{
+public:
+  ThemeResolver();
+
+  //does nothing if the paths are the same as the current ones
+  void set_theme(QString p_theme_path, QString p_default_theme_path);
+
+  //the value of p_identifier in p_file of the theme, or of the default theme if the theme doesn't have one
+  //the empty string if neither has it
+  QString get_value(QString p_identifier, QString p_file);
+
+  //the inis every theme has, these are parsed up front
+  static QStringList get_theme_files();
+
+  //identifier -> value of p_theme_path + p_file, falling back on p_default_theme_path + p_file per identifier
+  static QHash<QString, QString> parse_theme_file(QString p_theme_path, QString p_default_theme_path, QString p_file);
+
+private:
+  QMutex m_mutex;
+
+  bool m_theme_set = false;
+  QString m_theme_path;
+  QString m_default_theme_path;
+
+  //file name -> identifier -> value
+  QHash<QString, QHash<QString, QString>> m_files;
+
+  static QHash<QString, QString> parse_design_ini(QString p_path);
+};
+
+#endif // THEMERESOLVER_H